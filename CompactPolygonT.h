@@ -0,0 +1,264 @@
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+#include "PolygonT.h"
+
+// zigzag maps signed deltas to unsigned so small negative values stay small
+constexpr auto ZigZagEncode(int64_t value) -> uint64_t
+{
+    return (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);
+}
+
+constexpr auto ZigZagDecode(uint64_t value) -> int64_t
+{
+    return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+}
+
+// LEB128 style varint, 7 bits per byte, high bit set on all but the last byte
+inline auto AppendVarint(std::vector<uint8_t> &bytes, uint64_t value) -> void
+{
+    while (value >= 0x80)
+    {
+        bytes.push_back(static_cast<uint8_t>(value | 0x80));
+        value >>= 7;
+    }
+    bytes.push_back(static_cast<uint8_t>(value));
+}
+
+inline auto ReadVarint(const uint8_t *&cursor) -> uint64_t
+{
+    uint64_t value = 0;
+    for (int shift = 0;; shift += 7)
+    {
+        auto byte = *cursor++;
+        value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+        if (!(byte & 0x80))
+            return value;
+    }
+}
+
+/**
+ * @brief A read only polygon stored as quantized, delta and varint encoded vertices.
+ *
+ * Every vertex is snapped to a grid of step `scale` relative to a per polygon origin (the
+ * bbox minimum), and stored as the zigzag varint delta to the previous vertex. A typical
+ * boundary needs 2 to 4 bytes per coordinate instead of sizeof(POINTTYPE) per vertex.
+ * Integer coordinates keep an integer origin and are quantized in integer arithmetic, so the
+ * default scale of 1 is lossless for any int64_t values spanning less than 2^62; for floating
+ * point coordinates the caller picks the precision, within scale / 2 of the original boundary.
+ *
+ * Queries decode the ring on the fly through an EdgeCursor, nothing is materialised, and run
+ * in doubles relative to the origin, so large coordinates keep their precision as long as the
+ * polygon spans less than 2^53.
+ *
+ * @tparam POINTTYPE The type representing a point.
+ */
+template <typename POINTTYPE>
+class CompactPolygonT
+{
+public:
+    using COORDTYPE = get_coordinate_type_t<POINTTYPE>;
+    using ORIGINTYPE = std::conditional_t<std::is_integral<COORDTYPE>::value, int64_t, double>;
+
+    struct Edge
+    {
+        double start_x, start_y, end_x, end_y;
+    };
+
+    // streams the edges of the closed ring, decoding one vertex per edge
+    class EdgeCursor
+    {
+    public:
+        explicit EdgeCursor(const CompactPolygonT &polygon)
+            : _polygon(polygon), _cursor(polygon._bytes.data())
+        {
+            if (_polygon._count > 0)
+            {
+                ReadVertex(_first_x, _first_y);
+                _x = _first_x;
+                _y = _first_y;
+            }
+        }
+
+        auto Next(Edge &edge) -> bool
+        {
+            int64_t start_x, start_y, end_x, end_y;
+            if (!Next(start_x, start_y, end_x, end_y))
+                return false;
+            edge = {_polygon.ToCoordinate(start_x, _polygon._origin_x), _polygon.ToCoordinate(start_y, _polygon._origin_y),
+                    _polygon.ToCoordinate(end_x, _polygon._origin_x), _polygon.ToCoordinate(end_y, _polygon._origin_y)};
+            return true;
+        }
+
+        // the edge in grid steps from the origin
+        auto Next(int64_t &start_x, int64_t &start_y, int64_t &end_x, int64_t &end_y) -> bool
+        {
+            if (_emitted >= _polygon._count)
+                return false;
+            auto next_x = _first_x, next_y = _first_y;
+            if (++_emitted < _polygon._count)
+                ReadVertex(next_x, next_y);
+            start_x = _x;
+            start_y = _y;
+            end_x = _x = next_x;
+            end_y = _y = next_y;
+            return true;
+        }
+
+    private:
+        auto ReadVertex(int64_t &x, int64_t &y) -> void
+        {
+            _last_x += ZigZagDecode(ReadVarint(_cursor));
+            _last_y += ZigZagDecode(ReadVarint(_cursor));
+            x = _last_x;
+            y = _last_y;
+        }
+
+        const CompactPolygonT &_polygon;
+        const uint8_t *_cursor;
+        std::size_t _emitted = 0;
+        int64_t _last_x = 0, _last_y = 0;
+        int64_t _first_x = 0, _first_y = 0, _x = 0, _y = 0;
+    };
+
+    static constexpr double MAXGRID = 4611686018427387904.0; // 2^62
+
+    static constexpr auto DefaultScale() -> double { return std::is_integral<COORDTYPE>::value ? 1.0 : 1e-7; }
+
+    // throws std::invalid_argument unless scale is positive and the grid steps from the origin fit in 62 bits
+    template <typename POINTARRAY>
+    explicit CompactPolygonT(const POINTARRAY &points, double scale = DefaultScale())
+        : _scale(scale), _count(points.size())
+    {
+        static_assert(std::is_same<typename POINTARRAY::value_type, POINTTYPE>::value,
+                      "The point array must hold POINTTYPE");
+        // also rejects NaN
+        if (!(scale > 0))
+            throw std::invalid_argument("CompactPolygonT scale must be positive");
+        if (_count == 0)
+            return;
+        _origin_x = get_x(points[0]);
+        _origin_y = get_y(points[0]);
+        for (const auto &point : points)
+        {
+            _origin_x = std::min<ORIGINTYPE>(_origin_x, get_x(point));
+            _origin_y = std::min<ORIGINTYPE>(_origin_y, get_y(point));
+        }
+        _min_x = _min_y = std::numeric_limits<double>::max();
+        _max_x = _max_y = std::numeric_limits<double>::lowest();
+        int64_t last_x = 0, last_y = 0;
+        for (const auto &point : points)
+        {
+            auto x = ToGrid(get_x(point), _origin_x), y = ToGrid(get_y(point), _origin_y);
+            AppendVarint(_bytes, ZigZagEncode(x - last_x));
+            AppendVarint(_bytes, ZigZagEncode(y - last_y));
+            last_x = x;
+            last_y = y;
+            // the bbox of the snapped vertices relative to the origin, which is what the queries see
+            _min_x = std::min(_min_x, x * _scale);
+            _max_x = std::max(_max_x, x * _scale);
+            _min_y = std::min(_min_y, y * _scale);
+            _max_y = std::max(_max_y, y * _scale);
+        }
+        _bytes.shrink_to_fit();
+    }
+
+    auto VertexCount() const -> std::size_t { return _count; }
+    auto EncodedBytes() const -> std::size_t { return _bytes.size(); }
+    auto Scale() const -> double { return _scale; }
+    auto Edges() const -> EdgeCursor { return EdgeCursor(*this); }
+
+    // crossing number test over the streamed edges
+    auto Classify(const POINTTYPE &point) const -> PolygonTestResult
+    {
+        if (_count < 3)
+            return PolygonTestResult::UNKNOWN;
+        const double x = FromOrigin(get_x(point), _origin_x), y = FromOrigin(get_y(point), _origin_y);
+        if (x < _min_x - EPSILON || x > _max_x + EPSILON || y < _min_y - EPSILON || y > _max_y + EPSILON)
+            return PolygonTestResult::OutsidePolygon;
+        bool on_edge = false, inside = false;
+        auto edges = Edges();
+        int64_t start_x, start_y, end_x, end_y;
+        while (edges.Next(start_x, start_y, end_x, end_y))
+            CrossingNumberStep(start_x * _scale, start_y * _scale, end_x * _scale, end_y * _scale, x, y, on_edge, inside);
+        if (on_edge)
+            return PolygonTestResult::OnPolygonEdge;
+        return inside ? PolygonTestResult::InPolygon : PolygonTestResult::OutsidePolygon;
+    }
+
+    auto InPolygonTest(const POINTTYPE &point) const -> std::string
+    {
+        return _enumItemStrings[static_cast<int>(Classify(point))];
+    }
+
+    // appends the snapped vertices to a container with push_back
+    template <typename POINTARRAY>
+    auto Decode(POINTARRAY &points) const -> void
+    {
+        auto edges = Edges();
+        int64_t start_x, start_y, end_x, end_y;
+        while (edges.Next(start_x, start_y, end_x, end_y))
+            points.push_back(POINTTYPE(ToCoordinateType(start_x, _origin_x), ToCoordinateType(start_y, _origin_y)));
+    }
+
+private:
+    auto ToCoordinate(int64_t quantized, ORIGINTYPE origin) const -> double { return origin + quantized * _scale; }
+
+    auto ToCoordinateType(int64_t quantized, ORIGINTYPE origin) const -> COORDTYPE
+    {
+        if constexpr (std::is_integral<COORDTYPE>::value)
+            return static_cast<COORDTYPE>(origin + (_scale == 1 ? quantized : std::llround(quantized * _scale)));
+        else
+            return static_cast<COORDTYPE>(ToCoordinate(quantized, origin));
+    }
+
+    // grid steps of value from the origin, integers are offset without a round trip through double
+    auto ToGrid(COORDTYPE value, ORIGINTYPE origin) const -> int64_t
+    {
+        double grid;
+        if constexpr (std::is_integral<COORDTYPE>::value)
+        {
+            // exact, value >= origin, the difference of two int64_t fits in uint64_t
+            auto offset = static_cast<uint64_t>(static_cast<int64_t>(value)) - static_cast<uint64_t>(origin);
+            if (_scale == 1 && offset < static_cast<uint64_t>(MAXGRID))
+                return static_cast<int64_t>(offset);
+            grid = offset / _scale;
+        }
+        else
+        {
+            grid = (value - origin) / _scale;
+        }
+        // keeps llround defined and the deltas between vertices within int64_t
+        if (!(grid < MAXGRID))
+            throw std::invalid_argument("CompactPolygonT scale too small for the coordinate range");
+        return static_cast<int64_t>(std::llround(grid));
+    }
+
+    // value - origin as a double, exact for integers less than 2^53 apart
+    static auto FromOrigin(COORDTYPE value, ORIGINTYPE origin) -> double
+    {
+        if constexpr (std::is_integral<COORDTYPE>::value)
+        {
+            auto v = static_cast<int64_t>(value);
+            return v >= origin ? static_cast<double>(static_cast<uint64_t>(v) - static_cast<uint64_t>(origin))
+                               : -static_cast<double>(static_cast<uint64_t>(origin) - static_cast<uint64_t>(v));
+        }
+        else
+        {
+            return value - origin;
+        }
+    }
+
+    ORIGINTYPE _origin_x = 0, _origin_y = 0;
+    double _scale = 1;
+    double _min_x = 0, _max_x = 0, _min_y = 0, _max_y = 0; // relative to the origin
+    std::size_t _count = 0;
+    std::vector<uint8_t> _bytes;
+};
@@ -0,0 +1,157 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <string>
+#include <utility>
+#include "PolygonT.h"
+
+// edges up to this count are classified with a fully unrolled fold expression
+constexpr std::size_t FIXED_POLYGON_UNROLL_LIMIT = 16;
+
+/**
+ * @brief A polygon with a compile time vertex count that can be fully evaluated at compile time.
+ *
+ * The vertices are copied in, and the constructor validates the polygon and precomputes its
+ * bounding box and the edge terms, so a constexpr FixedPolygonT pays no runtime setup.
+ * Classify applies the CrossingNumberStep rule with those terms, so a query does no division,
+ * with the edges unrolled up to FIXED_POLYGON_UNROLL_LIMIT. A point within EPSILON of an edge
+ * is OnPolygonEdge.
+ *
+ * Unlike PolygonT::InPolygonTest the classification prints nothing and returns the enum.
+ *
+ * @tparam POINTTYPE The type representing a point.
+ * @tparam N The number of vertices.
+ */
+template <typename POINTTYPE, std::size_t N>
+class FixedPolygonT
+{
+    static_assert(N >= 3, "A polygon needs at least 3 points");
+
+public:
+    constexpr explicit FixedPolygonT(const std::array<POINTTYPE, N> &points) : _points(points)
+    {
+        _min_x = _max_x = fix_x(points[0]);
+        _min_y = _max_y = fix_y(points[0]);
+        for (std::size_t i = 0; i < N; ++i)
+        {
+            const auto &start = points[i];
+            const auto &end = points[(i + 1) % N];
+            auto &edge = _edges[i];
+            edge.start_x = fix_x(start);
+            edge.start_y = fix_y(start);
+            edge.end_y = fix_y(end);
+            edge.dx = fix_x(end) - edge.start_x;
+            edge.dy = edge.end_y - edge.start_y;
+            edge.dx_per_dy = edge.dy != 0 ? edge.dx / edge.dy : 0;
+            edge.on_edge_limit = EPSILON * EPSILON * (edge.dx * edge.dx + edge.dy * edge.dy);
+            edge.min_x = (edge.dx < 0 ? fix_x(end) : edge.start_x) - EPSILON;
+            edge.max_x = (edge.dx > 0 ? fix_x(end) : edge.start_x) + EPSILON;
+            edge.min_y = (edge.dy < 0 ? edge.end_y : edge.start_y) - EPSILON;
+            edge.max_y = (edge.dy > 0 ? edge.end_y : edge.start_y) + EPSILON;
+
+            _min_x = edge.start_x < _min_x ? edge.start_x : _min_x;
+            _max_x = edge.start_x > _max_x ? edge.start_x : _max_x;
+            _min_y = edge.start_y < _min_y ? edge.start_y : _min_y;
+            _max_y = edge.start_y > _max_y ? edge.start_y : _max_y;
+        }
+        _valid = Validate();
+    }
+
+    // false for zero length edges and adjacent edges that fold back onto each other,
+    // the polygons PolygonT::InPolygonTest reports as UNKNOWN
+    constexpr auto IsValid() const -> bool { return _valid; }
+
+    constexpr auto Classify(const POINTTYPE &point) const -> PolygonTestResult
+    {
+        if (!_valid)
+            return PolygonTestResult::UNKNOWN;
+        const double x = fix_x(point), y = fix_y(point);
+        if (x < _min_x - EPSILON || x > _max_x + EPSILON || y < _min_y - EPSILON || y > _max_y + EPSILON)
+            return PolygonTestResult::OutsidePolygon;
+
+        bool on_edge = false, inside = false;
+        if constexpr (N <= FIXED_POLYGON_UNROLL_LIMIT)
+        {
+            ClassifyUnrolled(x, y, on_edge, inside, std::make_index_sequence<N>{});
+        }
+        else
+        {
+            for (std::size_t i = 0; i < N; ++i)
+                ClassifyEdge(_edges[i], x, y, on_edge, inside);
+        }
+        if (on_edge)
+            return PolygonTestResult::OnPolygonEdge;
+        return inside ? PolygonTestResult::InPolygon : PolygonTestResult::OutsidePolygon;
+    }
+
+    auto InPolygonTest(const POINTTYPE &point) const -> std::string
+    {
+        return _enumItemStrings[static_cast<int>(Classify(point))];
+    }
+
+    constexpr auto Points() const -> const std::array<POINTTYPE, N> & { return _points; }
+    constexpr auto MinX() const -> double { return _min_x; }
+    constexpr auto MaxX() const -> double { return _max_x; }
+    constexpr auto MinY() const -> double { return _min_y; }
+    constexpr auto MaxY() const -> double { return _max_y; }
+
+private:
+    // the terms of CrossingNumberStep that depend only on the edge
+    struct Edge
+    {
+        double start_x = 0, start_y = 0, end_y = 0;
+        double dx = 0, dy = 0, dx_per_dy = 0;
+        double on_edge_limit = 0; // EPSILON^2 * length^2
+        double min_x = 0, max_x = 0, min_y = 0, max_y = 0; // bbox grown by EPSILON
+    };
+
+    constexpr auto Validate() const -> bool
+    {
+        for (std::size_t i = 0; i < N; ++i)
+        {
+            const auto &edge = _edges[i];
+            const auto &next = _edges[(i + 1) % N];
+            if (edge.dx == 0 && edge.dy == 0)
+                return false;
+            // collinear adjacent edges pointing in opposite directions overlap
+            auto cross = edge.dx * next.dy - edge.dy * next.dx;
+            auto dot = edge.dx * next.dx + edge.dy * next.dy;
+            if (cross == 0 && dot < 0)
+                return false;
+        }
+        return true;
+    }
+
+    static constexpr auto ClassifyEdge(const Edge &edge, double x, double y, bool &on_edge, bool &inside) -> void
+    {
+        auto cross = edge.dx * (y - edge.start_y) - edge.dy * (x - edge.start_x);
+        if (cross * cross <= edge.on_edge_limit && x >= edge.min_x && x <= edge.max_x && y >= edge.min_y &&
+            y <= edge.max_y)
+        {
+            on_edge = true;
+        }
+        // half open rule, a vertex on the ray is counted once
+        if ((edge.start_y > y) != (edge.end_y > y) && x < edge.start_x + (y - edge.start_y) * edge.dx_per_dy)
+        {
+            inside = !inside;
+        }
+    }
+
+    template <std::size_t... I>
+    constexpr auto ClassifyUnrolled(double x, double y, bool &on_edge, bool &inside, std::index_sequence<I...>) const -> void
+    {
+        (ClassifyEdge(_edges[I], x, y, on_edge, inside), ...);
+    }
+
+    std::array<POINTTYPE, N> _points;
+    std::array<Edge, N> _edges{};
+    double _min_x = 0, _max_x = 0, _min_y = 0, _max_y = 0;
+    bool _valid = false;
+};
+
+template <typename POINTTYPE, std::size_t N>
+constexpr auto MakeFixedPolygon(const std::array<POINTTYPE, N> &points) -> FixedPolygonT<POINTTYPE, N>
+{
+    return FixedPolygonT<POINTTYPE, N>(points);
+}
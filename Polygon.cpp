@@ -4,9 +4,19 @@
 #include <iostream>
 #include <stack>
 #include "PolygonT.h"
+#include "clip_stream.h"
+#include "FixedPolygonT.h"
+#include "CompactPolygonT.h"
+#include "SimplifiedPolygonT.h"
+#include "PolygonBVHT.h"
+#include "lattice.h"
+#include "SlabPolygonT.h"
+#include "hilbert_batch.h"
+#include "query_cache.h"
 #include "traits.h"
 // To compile with g++:
 //     g++ -o Polygon.exe Polygon.cpp
+// add -DPOLYGON_INSTRUMENTATION to collect hot path counters and latency histograms
 // The functions to implement are:
 // PolygonT.h
 //  SegmentIntersection,
@@ -113,10 +123,158 @@ auto my_test() -> void
           std::vector<doublePoint> toclip = {{-3, -3}, {2, -1}, {0, 2}, {2, 4}, {1, 5}, {-3, 3}, {-2, 0}}, clipped;
           polygon.ClipSegments(toclip, clipped);
      }
+     {
+          // clip with all temporaries and the output in a stack arena
+          using doublePoint = PointXYT<double>;
+          std::pmr::vector<doublePoint> pointArray = {{-3, -3}, {2, -1}, {2, 3}, {1, 6}, {-2, 3}};
+          PolygonT<std::pmr::vector<doublePoint>> polygon(pointArray);
+          std::pmr::vector<doublePoint> toclip = {{-3, -3}, {2, -1}, {0, 2}, {2, 4}, {1, 5}, {-3, 3}, {-2, 0}};
+          std::array<std::byte, 4096> buffer;
+          std::pmr::monotonic_buffer_resource arena(buffer.data(), buffer.size());
+          std::pmr::vector<doublePoint> clipped(&arena);
+          polygon.ClipSegments(toclip, clipped, &arena);
+     }
+     {
+          // consume the clipped segments one by one as they are computed
+          using doublePoint = PointXYT<double>;
+          std::vector<doublePoint> pointArray = {{-3, -3}, {2, -1}, {2, 3}, {1, 6}, {-2, 3}};
+          PolygonT<std::vector<doublePoint>> polygon(pointArray);
+          std::vector<doublePoint> toclip = {{-3, -3}, {2, -1}, {0, 2}, {2, 4}, {1, 5}, {-3, 3}, {-2, 0}};
+          for (const auto &segment : ClipStream<std::vector<doublePoint>>(polygon, toclip))
+               std::cout << "clipped segment " << segment.first << " -> " << segment.second << std::endl;
+     }
+     {
+          // path segments clipped on 3 threads sharing a stack arena, same output as ClipSegments
+          using doublePoint = PointXYT<double>;
+          std::vector<doublePoint> pointArray = {{-3, -3}, {2, -1}, {2, 3}, {1, 6}, {-2, 3}};
+          PolygonT<std::vector<doublePoint>> polygon(pointArray);
+          std::vector<doublePoint> toclip = {{-3, -3}, {2, -1}, {0, 2}, {2, 4}, {1, 5}, {-3, 3}, {-2, 0}}, clipped;
+          std::array<std::byte, 4096> buffer;
+          std::pmr::monotonic_buffer_resource arena(buffer.data(), buffer.size());
+          polygon.ClipSegmentsParallel(toclip, clipped, &arena, 3);
+     }
+}
+auto fixed_polygon_test() -> void
+{
+     // validated, with bbox and edge coefficients computed at compile time
+     using IntPoint = Point2DT<int>;
+     constexpr std::array<IntPoint, 7> pointArray = {{{-3, -3}, {2, -1}, {0, 2}, {2, 4}, {1, 6}, {-3, 3}, {-2, 0}}};
+     constexpr auto polygon = MakeFixedPolygon(pointArray);
+     static_assert(polygon.IsValid(), "fixed polygon must be valid");
+     static_assert(polygon.Classify(IntPoint(0, 0)) == PolygonTestResult::InPolygon, "");
+     static_assert(polygon.Classify(IntPoint(1, 1)) == PolygonTestResult::OutsidePolygon, "");
+     static_assert(polygon.Classify(IntPoint(-3, -3)) == PolygonTestResult::OnPolygonEdge, "");
+     std::cout << "2,3 in fixed polygon is " << polygon.InPolygonTest(IntPoint(2, 3)) << std::endl;
+}
+auto compact_polygon_test() -> void
+{
+     {
+          using ShortPoint = Point2DT<int16_t>;
+          std::vector<ShortPoint> pointArray = {{-3, -3}, {2, -1}, {0, 2}, {2, 4}, {1, 6}, {-3, 3}, {-2, 0}};
+          PolygonT<std::vector<ShortPoint>> polygon(pointArray);
+          polygon.InPolygonTest(ShortPoint(0, 0));
+          CompactPolygonT<ShortPoint> compact(pointArray);
+          std::cout << "0,0 in compact polygon of " << compact.EncodedBytes() << " bytes is "
+                    << compact.InPolygonTest(ShortPoint(0, 0)) << std::endl;
+     }
+     {
+          using floatPoint = PointXYT<float>;
+          std::vector<floatPoint> pointArray = {{-3, -3}, {2, -1}, {2, 3}, {1, 6}, {-2, 3}};
+          PolygonT<std::vector<floatPoint>> polygon(pointArray);
+          polygon.InPolygonTest(floatPoint(1.5f, 4.5f));
+          CompactPolygonT<floatPoint> compact(pointArray, 1e-3);
+          std::cout << "1.5,4.5 in compact polygon of " << compact.EncodedBytes() << " bytes is "
+                    << compact.InPolygonTest(floatPoint(1.5f, 4.5f)) << std::endl;
+     }
+}
+auto simplified_polygon_test() -> void
+{
+     // an oversampled circle, most points are answered by the 2 coarse levels
+     using doublePoint = Point2DT<double>;
+     // M_PI is POSIX, not standard C++
+     constexpr double PI = 3.14159265358979323846;
+     std::vector<doublePoint> pointArray;
+     for (auto i = 0; i < 10000; ++i)
+          pointArray.push_back(doublePoint(10 * std::cos(i * 2 * PI / 10000), 10 * std::sin(i * 2 * PI / 10000)));
+     SimplifiedPolygonT<std::vector<doublePoint>> polygon(pointArray, {0.01, 0.5});
+     for (std::size_t i = 0; i < polygon.LevelCount(); ++i)
+          std::cout << "level " << i << ": " << polygon.GetLevel(i).indices.size() << " points, deviation "
+                    << polygon.GetLevel(i).deviation << std::endl;
+     std::cout << "1,1 in simplified polygon is " << polygon.InPolygonTest(doublePoint(1, 1)) << std::endl;
+     std::cout << "10,0 in simplified polygon is " << polygon.InPolygonTest(doublePoint(10, 0)) << std::endl;
+     std::cout << "11,0 in simplified polygon is " << polygon.InPolygonTest(doublePoint(11, 0)) << std::endl;
+}
+auto polygon_bvh_test() -> void
+{
+     using doublePoint = PointXYT<double>;
+     std::vector<doublePoint> pointArray = {{-3, -3}, {2, -1}, {2, 3}, {1, 6}, {-2, 3}};
+     PolygonBVHT<doublePoint> polygon(pointArray);
+     auto nearest = polygon.Nearest(doublePoint(3, 0));
+     std::cout << "3,0 is " << nearest.distance << " from edge " << nearest.edge << ", signed distance of 0,0 is "
+               << polygon.SignedDistance(doublePoint(0, 0)) << std::endl;
+     std::cout << "2.5,0 in bvh polygon is " << polygon.InPolygonTest(doublePoint(2.5, 0)) << ", with tolerance 1 "
+               << polygon.InPolygonTest(doublePoint(2.5, 0), 1) << std::endl;
+}
+auto lattice_test() -> void
+{
+     // a raster mask, 'o' on the edge, '#' inside, '.' outside
+     using IntPoint = Point2DT<int>;
+     std::vector<IntPoint> pointArray = {{-3, -3}, {2, -1}, {0, 2}, {2, 4}, {1, 6}, {-3, 3}, {-2, 0}};
+     LatticeSpec lattice{-4, -4, 0.5, 1, 15, 12};
+     ClassifyLatticeRows(pointArray, lattice, [&](std::size_t, const PolygonTestResult *cells)
+                         {
+                              for (std::size_t column = 0; column < lattice.columns; ++column)
+                                   std::cout << (cells[column] == PolygonTestResult::OnPolygonEdge ? 'o'
+                                                 : cells[column] == PolygonTestResult::InPolygon ? '#' : '.');
+                              std::cout << std::endl; });
+}
+auto batch_test() -> void
+{
+     using doublePoint = PointXYT<double>;
+     std::vector<doublePoint> pointArray = {{-3, -3}, {2, -1}, {2, 3}, {1, 6}, {-2, 3}};
+     SlabPolygonT<doublePoint> polygon(pointArray);
+     std::vector<doublePoint> queries = {{1.5, 4.5}, {2, 0}, {5, 5}, {0, 0}, {-2.9, -2.9}, {1.9, 2.9}};
+     auto order = HilbertOrder(queries);
+     auto slab_results = BatchClassify(polygon, queries, order);
+     auto bvh_results = BatchClassify(PolygonBVHT<doublePoint>(pointArray), queries, order);
+     auto polygon_results = BatchClassify(PolygonT<std::vector<doublePoint>>(pointArray), queries, order);
+     std::cout << polygon.SlabCount() << " slabs, batch in hilbert order:";
+     for (auto i : order)
+          std::cout << " " << i;
+     std::cout << std::endl;
+     for (std::size_t i = 0; i < queries.size(); ++i)
+          std::cout << get_x(queries[i]) << "," << get_y(queries[i]) << " in batch is " << _enumItemStrings[static_cast<int>(slab_results[i])]
+                    << (slab_results[i] == bvh_results[i] ? "" : " (bvh differs)")
+                    << (slab_results[i] == polygon_results[i] ? "" : " (polygon differs)") << std::endl;
+}
+auto query_cache_test() -> void
+{
+     using doublePoint = PointXYT<double>;
+     std::vector<doublePoint> pointArray = {{-3, -3}, {2, -1}, {2, 3}, {1, 6}, {-2, 3}};
+     SlabPolygonT<doublePoint> polygon(pointArray);
+     QueryCacheT<doublePoint> cache(1024, 4);
+     CachedClassifierT cached(polygon, cache, 1);
+     std::vector<doublePoint> queries = {{0, 0}, {5, 5}, {0, 0}, {2, 0}, {0, 0}, {5, 5}};
+     for (const auto &point : queries)
+          cached.Classify(point);
+     cached.SetVersion(2);
+     std::cout << "0,0 in cached polygon is " << cached.InPolygonTest(doublePoint(0, 0)) << std::endl;
+     auto stats = cache.GetStats();
+     std::cout << "cache hits " << stats.hits << ", misses " << stats.misses << ", entries " << stats.size << std::endl;
 }
 int main()
 {
      PolygonTest();
      my_test();
+     fixed_polygon_test();
+     compact_polygon_test();
+     simplified_polygon_test();
+     polygon_bvh_test();
+     lattice_test();
+     batch_test();
+     query_cache_test();
+#ifdef POLYGON_INSTRUMENTATION
+     PolygonInstrumentation::Export(std::cout);
+#endif
      return 0;
 }
@@ -0,0 +1,256 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <vector>
+#include "PolygonT.h"
+
+/**
+ * @brief Bounding volume hierarchy over the edges of a polygon for distance queries.
+ *
+ * Answers nearest edge, (signed) distance to the boundary and "within d of the boundary"
+ * queries in logarithmic time, and classifies points with a per query edge tolerance
+ * instead of the global EPSILON used by OnSegment.
+ *
+ * The edges are copied into the hierarchy, the source points are not referenced afterwards.
+ * Nodes are median splits along the longer axis of the edge centres, stored in one array.
+ *
+ * @tparam POINTTYPE The type representing a point.
+ */
+template <typename POINTTYPE>
+class PolygonBVHT
+{
+public:
+    struct NearestEdge
+    {
+        std::size_t edge = 0; // the edge from vertex edge to vertex edge + 1
+        double distance = std::numeric_limits<double>::infinity();
+    };
+
+    template <typename POINTARRAY>
+    explicit PolygonBVHT(const POINTARRAY &points)
+    {
+        static_assert(has_indexer_v<POINTARRAY>,
+                      "Template argument must have an indexer");
+        const auto n = points.size();
+        if (n < 3)
+            return;
+        _edges.reserve(n);
+        for (std::size_t i = 0; i < n; ++i)
+        {
+            const auto &start = points[i];
+            const auto &end = points[(i + 1) % n];
+            _edges.push_back({static_cast<double>(fix_x(start)), static_cast<double>(fix_y(start)),
+                              static_cast<double>(fix_x(end)), static_cast<double>(fix_y(end)), i});
+        }
+        _nodes.reserve(2 * n / LEAFSIZE + 1);
+        Build(0, n);
+    }
+
+    auto EdgeCount() const -> std::size_t { return _edges.size(); }
+
+    // the closest edge of the boundary, at infinite distance for an invalid polygon
+    auto Nearest(const POINTTYPE &point) const -> NearestEdge
+    {
+        NearestEdge best;
+        if (_nodes.empty())
+            return best;
+        const double x = fix_x(point), y = fix_y(point);
+        auto best_squared = std::numeric_limits<double>::infinity();
+        std::array<std::pair<std::uint32_t, double>, STACKSIZE> stack;
+        std::size_t top = 0;
+        stack[top++] = {0, _nodes[0].DistanceSquared(x, y)};
+        while (top)
+        {
+            auto [index, bound] = stack[--top];
+            if (bound >= best_squared)
+                continue;
+            const auto &node = _nodes[index];
+            if (node.count)
+            {
+                for (auto i = node.first; i < node.first + node.count; ++i)
+                {
+                    const auto &edge = _edges[i];
+                    auto d = SegmentDistanceSquared(x, y, edge.start_x, edge.start_y, edge.end_x, edge.end_y);
+                    if (d < best_squared)
+                    {
+                        best_squared = d;
+                        best.edge = edge.index;
+                    }
+                }
+                continue;
+            }
+            // visit the closer child first, it is pushed last
+            auto left = index + 1, right = node.first;
+            auto left_bound = _nodes[left].DistanceSquared(x, y), right_bound = _nodes[right].DistanceSquared(x, y);
+            if (left_bound < right_bound)
+            {
+                std::swap(left, right);
+                std::swap(left_bound, right_bound);
+            }
+            stack[top++] = {left, left_bound};
+            stack[top++] = {right, right_bound};
+        }
+        best.distance = std::sqrt(best_squared);
+        return best;
+    }
+
+    auto Distance(const POINTTYPE &point) const -> double { return Nearest(point).distance; }
+
+    // negative inside, positive outside, 0 on the boundary
+    auto SignedDistance(const POINTTYPE &point) const -> double
+    {
+        auto distance = Distance(point);
+        return Inside(fix_x(point), fix_y(point)) ? -distance : distance;
+    }
+
+    // true if some edge is within tolerance of the point, stops at the first one found,
+    // always false for a negative or NaN tolerance
+    auto WithinDistance(const POINTTYPE &point, double tolerance) const -> bool
+    {
+        if (_nodes.empty() || !(tolerance >= 0))
+            return false;
+        const double x = fix_x(point), y = fix_y(point);
+        const auto tolerance_squared = tolerance * tolerance;
+        std::array<std::uint32_t, STACKSIZE> stack;
+        std::size_t top = 0;
+        stack[top++] = 0;
+        while (top)
+        {
+            const auto &node = _nodes[stack[--top]];
+            if (node.DistanceSquared(x, y) > tolerance_squared)
+                continue;
+            if (node.count)
+            {
+                for (auto i = node.first; i < node.first + node.count; ++i)
+                {
+                    const auto &edge = _edges[i];
+                    if (SegmentDistanceSquared(x, y, edge.start_x, edge.start_y, edge.end_x, edge.end_y) <= tolerance_squared)
+                        return true;
+                }
+                continue;
+            }
+            stack[top++] = static_cast<std::uint32_t>(&node - _nodes.data()) + 1;
+            stack[top++] = node.first;
+        }
+        return false;
+    }
+
+    // like InPolygonTest, with OnPolygonEdge meaning within tolerance of the boundary,
+    // a negative or NaN tolerance never reports OnPolygonEdge
+    auto Classify(const POINTTYPE &point, double tolerance = EPSILON) const -> PolygonTestResult
+    {
+        if (_nodes.empty())
+            return PolygonTestResult::UNKNOWN;
+        if (WithinDistance(point, tolerance))
+            return PolygonTestResult::OnPolygonEdge;
+        return Inside(fix_x(point), fix_y(point)) ? PolygonTestResult::InPolygon : PolygonTestResult::OutsidePolygon;
+    }
+
+    auto InPolygonTest(const POINTTYPE &point, double tolerance = EPSILON) const -> std::string
+    {
+        return _enumItemStrings[static_cast<int>(Classify(point, tolerance))];
+    }
+
+private:
+    static constexpr std::size_t LEAFSIZE = 4;
+    // median splits keep the depth near log2(n / LEAFSIZE), far below this
+    static constexpr std::size_t STACKSIZE = 128;
+
+    struct Edge
+    {
+        double start_x, start_y, end_x, end_y;
+        std::size_t index;
+        auto CenterX() const -> double { return 0.5 * (start_x + end_x); }
+        auto CenterY() const -> double { return 0.5 * (start_y + end_y); }
+    };
+
+    // inner nodes have count 0, their left child follows them and first is the right child
+    struct Node
+    {
+        double min_x, min_y, max_x, max_y;
+        std::uint32_t first, count;
+
+        auto DistanceSquared(double x, double y) const -> double
+        {
+            auto dx = x < min_x ? min_x - x : (x > max_x ? x - max_x : 0.0);
+            auto dy = y < min_y ? min_y - y : (y > max_y ? y - max_y : 0.0);
+            return dx * dx + dy * dy;
+        }
+    };
+
+    auto Build(std::size_t first, std::size_t last) -> std::uint32_t
+    {
+        auto index = static_cast<std::uint32_t>(_nodes.size());
+        _nodes.push_back({});
+        Node node{std::numeric_limits<double>::max(), std::numeric_limits<double>::max(),
+                  std::numeric_limits<double>::lowest(), std::numeric_limits<double>::lowest(), 0, 0};
+        double center_min_x = std::numeric_limits<double>::max(), center_max_x = std::numeric_limits<double>::lowest();
+        double center_min_y = center_min_x, center_max_y = center_max_x;
+        for (auto i = first; i < last; ++i)
+        {
+            const auto &edge = _edges[i];
+            node.min_x = std::min({node.min_x, edge.start_x, edge.end_x});
+            node.min_y = std::min({node.min_y, edge.start_y, edge.end_y});
+            node.max_x = std::max({node.max_x, edge.start_x, edge.end_x});
+            node.max_y = std::max({node.max_y, edge.start_y, edge.end_y});
+            center_min_x = std::min(center_min_x, edge.CenterX());
+            center_max_x = std::max(center_max_x, edge.CenterX());
+            center_min_y = std::min(center_min_y, edge.CenterY());
+            center_max_y = std::max(center_max_y, edge.CenterY());
+        }
+        if (last - first <= LEAFSIZE)
+        {
+            node.first = static_cast<std::uint32_t>(first);
+            node.count = static_cast<std::uint32_t>(last - first);
+            _nodes[index] = node;
+            return index;
+        }
+        auto middle = first + (last - first) / 2;
+        auto by_x = center_max_x - center_min_x >= center_max_y - center_min_y;
+        std::nth_element(_edges.begin() + first, _edges.begin() + middle, _edges.begin() + last,
+                         [by_x](const Edge &a, const Edge &b)
+                         { return by_x ? a.CenterX() < b.CenterX() : a.CenterY() < b.CenterY(); });
+        _nodes[index] = node;
+        Build(first, middle);
+        auto right = Build(middle, last);
+        _nodes[index].first = right;
+        return index;
+    }
+
+    // crossing number, only visiting nodes the +x ray from (x, y) can hit
+    auto Inside(double x, double y) const -> bool
+    {
+        bool inside = false, on_edge = false;
+        std::array<std::uint32_t, STACKSIZE> stack;
+        std::size_t top = 0;
+        stack[top++] = 0;
+        while (top)
+        {
+            auto index = stack[--top];
+            const auto &node = _nodes[index];
+            if (y < node.min_y || y > node.max_y || x > node.max_x)
+                continue;
+            if (node.count)
+            {
+                for (auto i = node.first; i < node.first + node.count; ++i)
+                {
+                    const auto &edge = _edges[i];
+                    CrossingNumberStep(edge.start_x, edge.start_y, edge.end_x, edge.end_y, x, y, on_edge, inside);
+                }
+                continue;
+            }
+            stack[top++] = index + 1;
+            stack[top++] = node.first;
+        }
+        return inside;
+    }
+
+    std::vector<Edge> _edges;
+    std::vector<Node> _nodes;
+};
@@ -7,10 +7,15 @@
 #include <vector>
 #include <limits>
 #include <cmath>
-#include <set>
-#include "traits.h"
-
+#include <memory_resource>
+#include <condition_variable>
+#include <mutex>
+#include <iostream>
+#include <sstream>
+#include <thread>
 #include "traits.h"
+#include "instrumentation.h"
+#include "inline_vector.h"
 
 #define POLYGONINOUTSTATUS(code) \
     code(UNKNOWN) code(InPolygon) code(OnPolygonEdge) code(OutsidePolygon)
@@ -29,14 +34,14 @@ const std::array<std::string, static_cast<int>(PolygonTestResult::STATECOUNT)> _
 }};
 
 template <typename POINTARRAY>
-auto PrintPolygon(const POINTARRAY &polygon) -> void
+auto PrintPolygon(const POINTARRAY &polygon, std::ostream &stream = std::cout) -> void
 {
     using POINTTYPE = typename POINTARRAY::value_type;
-    std::for_each(polygon.cbegin(), polygon.cend(), [](const POINTTYPE &point)
-                  { std::cout << point << ", "; });
+    std::for_each(polygon.cbegin(), polygon.cend(), [&stream](const POINTTYPE &point)
+                  { stream << point << ", "; });
 }
 
-const double EPSILON = 1e-6;
+constexpr double EPSILON = 1e-6;
 /**
  * @brief Checks if a given point lies on a line segment.
  *
@@ -64,10 +69,20 @@ auto OnSegment(const POINTTYPE &p, const POINTTYPE &start, const POINTTYPE &end)
     return false;
 }
 
-// Specialized function for when the first parameter is a std::vector<double>
+// (x, y) of a computed intersection, kept as double whatever the coordinate type is
+using IntersectionCoords = std::array<double, 2>;
+
+// at most four distinct candidates for two collinear segments, a single one otherwise
+using IntersectionResult = InlineVector<IntersectionCoords, 4>;
+
+// intersection points of two segments in the coordinate type of the polygon
 template <typename POINTTYPE>
-typename std::enable_if<!std::is_same<POINTTYPE, std::vector<double>>::value, bool>::type
-OnSegment(const std::vector<double> &p, const POINTTYPE &start, const POINTTYPE &end)
+using SegmentIntersectionPoints = InlineVector<POINTTYPE, 4>;
+
+// Specialized function for when the first parameter is a coordinate pair
+template <typename COORDS, typename POINTTYPE>
+typename std::enable_if<is_one_of_v<COORDS, std::vector<double>, IntersectionCoords> && !std::is_same<POINTTYPE, COORDS>::value, bool>::type
+OnSegment(const COORDS &p, const POINTTYPE &start, const POINTTYPE &end)
 {
     auto d1 = sqrt((p[0] - fix_x(start))*(p[0] - fix_x(start)) + (p[1] - fix_y(start))*(p[1] - fix_y(start))); 
     auto d2 = sqrt((p[0] - fix_x(end))*(p[0] - fix_x(end)) + (p[1] - fix_y(end))*(p[1] - fix_y(end))); 
@@ -79,6 +94,45 @@ OnSegment(const std::vector<double> &p, const POINTTYPE &start, const POINTTYPE
     return false;
 }
 
+/**
+ * @brief One edge step of the crossing number point in polygon test.
+ *
+ * Flips `inside` when the horizontal ray from (x, y) towards +x crosses the edge from
+ * (start_x, start_y) to (end_x, end_y), using the half open rule so a vertex on the ray
+ * counts once, and sets `on_edge` when the point is within EPSILON of the edge.
+ * Calling it for every edge of a closed ring classifies the point.
+ */
+constexpr auto CrossingNumberStep(double start_x, double start_y, double end_x, double end_y,
+                                  double x, double y, bool &on_edge, bool &inside) -> void
+{
+    auto dx = end_x - start_x, dy = end_y - start_y;
+    auto cross = dx * (y - start_y) - dy * (x - start_x);
+    auto length_squared = dx * dx + dy * dy;
+    // |cross| / length is the distance to the line, compared squared to avoid sqrt
+    if (cross * cross <= EPSILON * EPSILON * length_squared &&
+        x >= (start_x < end_x ? start_x : end_x) - EPSILON && x <= (start_x > end_x ? start_x : end_x) + EPSILON &&
+        y >= (start_y < end_y ? start_y : end_y) - EPSILON && y <= (start_y > end_y ? start_y : end_y) + EPSILON)
+    {
+        on_edge = true;
+    }
+    if ((start_y > y) != (end_y > y) && x < start_x + (y - start_y) * dx / dy)
+    {
+        inside = !inside;
+    }
+}
+
+// squared distance from (x, y) to the segment from (start_x, start_y) to (end_x, end_y)
+constexpr auto SegmentDistanceSquared(double x, double y, double start_x, double start_y, double end_x, double end_y)
+    -> double
+{
+    auto dx = end_x - start_x, dy = end_y - start_y;
+    auto length_squared = dx * dx + dy * dy;
+    auto t = length_squared > 0 ? ((x - start_x) * dx + (y - start_y) * dy) / length_squared : 0.0;
+    t = t < 0 ? 0 : (t > 1 ? 1 : t);
+    auto px = start_x + t * dx - x, py = start_y + t * dy - y;
+    return px * px + py * py;
+}
+
 /**
  * @brief Calculates the intersection of two parallel line segments.
  *
@@ -91,47 +145,48 @@ OnSegment(const std::vector<double> &p, const POINTTYPE &start, const POINTTYPE
  * @param q1 The second endpoint of the first line segment.
  * @param p2 The first endpoint of the second line segment.
  * @param q2 The second endpoint of the second line segment.
- * @param intersections A vector to store the intersection points if any.
- * @return A vector of vectors of doubles representing the intersection points. 
+ * @param intersections A container with push_back to store the intersection points if any.
+ * @return The sorted, unique intersection points as doubles.
  */
-template <typename POINTTYPE>
-std::vector<std::vector<double>>
-ParallelSegmentIntersection(const POINTTYPE &p1, const POINTTYPE &q1, const POINTTYPE &p2, const POINTTYPE &q2, std::vector<POINTTYPE> &intersectons)
+template <typename POINTTYPE, typename OUTPUT>
+IntersectionResult
+ParallelSegmentIntersection(const POINTTYPE &p1, const POINTTYPE &q1, const POINTTYPE &p2, const POINTTYPE &q2, OUTPUT &intersectons)
 {
-    auto unique_points = std::set<std::vector<double>>{};
-    auto unique_intersectons = std::set<POINTTYPE>{};
+    POLYGON_COUNT(ParallelSegmentIntersections, 1);
+    auto unique_points = IntersectionResult{};
+    auto unique_intersectons = SegmentIntersectionPoints<POINTTYPE>{};
     if (OnSegment(p1, p2, q2)) {
-        unique_intersectons.insert(p1);
-        unique_points.insert({double(fix_x(p1)), double(fix_y(p1))});
+        unique_intersectons.insert_unique(p1);
+        unique_points.insert_unique({double(fix_x(p1)), double(fix_y(p1))});
     }
     if (OnSegment(q1, p2, q2)) {
-        unique_intersectons.insert(q1);
-        unique_points.insert({double(fix_x(q1)), double(fix_y(q1))});
+        unique_intersectons.insert_unique(q1);
+        unique_points.insert_unique({double(fix_x(q1)), double(fix_y(q1))});
     }
     if (OnSegment(p2, p1, q1)) {
-        unique_intersectons.insert(p2);
-        unique_points.insert({double(fix_x(p2)), double(fix_y(p2))});
+        unique_intersectons.insert_unique(p2);
+        unique_points.insert_unique({double(fix_x(p2)), double(fix_y(p2))});
     }
     if (OnSegment(q2, p1, q1)) {
-        unique_intersectons.insert(q2);
-        unique_points.insert({double(fix_x(q2)), double(fix_y(q2))});
+        unique_intersectons.insert_unique(q2);
+        unique_points.insert_unique({double(fix_x(q2)), double(fix_y(q2))});
     }
     for (auto interaction : unique_intersectons) {
         intersectons.push_back(interaction);
     }
-    return std::vector<std::vector<double>>(unique_points.begin(), unique_points.end());
+    return unique_points;
 }
 
 // given two points, get the A, B, C of the linear equation Ax + By + C = 0
 // formed by the two points
 template <typename POINTTYPE>
-std::vector<double> GetLineParameter(const POINTTYPE &point1, const POINTTYPE &point2)
+std::array<double, 3> GetLineParameter(const POINTTYPE &point1, const POINTTYPE &point2)
 {
     // A = y2-y1, B = x1-x2, C = x2y1-x1y2
     double a = fix_y(point2) - fix_y(point1);
     double b = fix_x(point1) - fix_x(point2);
     double c = fix_x(point2) * fix_y(point1) - fix_x(point1) * fix_y(point2);
-    return std::vector<double>{a, b, c};
+    return {a, b, c};
 }
 
 /**
@@ -145,13 +200,16 @@ std::vector<double> GetLineParameter(const POINTTYPE &point1, const POINTTYPE &p
  * @param q1 The second endpoint of the first line segment.
  * @param p2 The first endpoint of the second line segment.
  * @param q2 The second endpoint of the second line segment.
- * @param intersections A vector to store the intersection points if any.
- * @return A vector of vectors of doubles representing the intersection points. 
+ * @param intersections A container with push_back to store the intersection points if any,
+ *        a SegmentIntersectionPoints keeps the whole call free of heap allocations.
+ * @return The intersection points as doubles.
  */
-template <typename POINTTYPE, typename T = get_coordinate_type_t<POINTTYPE>>
-std::vector<std::vector<double>>
-SegmentIntersection(const POINTTYPE &p1, const POINTTYPE &q1, const POINTTYPE &p2, const POINTTYPE &q2, std::vector<POINTTYPE> &intersectons)
+template <typename POINTTYPE, typename OUTPUT, typename T = get_coordinate_type_t<POINTTYPE>>
+IntersectionResult
+SegmentIntersection(const POINTTYPE &p1, const POINTTYPE &q1, const POINTTYPE &p2, const POINTTYPE &q2, OUTPUT &intersectons)
 {
+    POLYGON_TIMED_SCOPE(SegmentIntersection, nullptr);
+    POLYGON_COUNT(SegmentIntersections, 1);
     // Find the four orientations needed for general and special cases
     auto dx1 = fix_x(q1) - fix_x(p1);
     auto dy1 = fix_y(q1) - fix_y(p1);
@@ -170,8 +228,8 @@ SegmentIntersection(const POINTTYPE &p1, const POINTTYPE &q1, const POINTTYPE &p
     auto x = (v2[2] * v1[1] - v1[2] * v2[1]) / (v1[0] * v2[1] - v2[0] * v1[1]);
     auto y = (v1[2] * v2[0] - v2[2] * v1[0]) / (v1[0] * v2[1] - v2[0] * v1[1]);
 
-    auto result = std::vector<std::vector<double>>{};
-    auto point = std::vector<double>{x, y};
+    auto result = IntersectionResult{};
+    auto point = IntersectionCoords{x, y};
     POINTTYPE intersection = {static_cast<T>(x), static_cast<T>(y)};
 
     if (OnSegment(point, p1, q1) && OnSegment(point, p2, q2))
@@ -196,6 +254,27 @@ public:
     virtual ~PolygonT() = default;
     auto InPolygonTest(const POINTTYPE &point) const -> std::string
     {
+        return InPolygonTest(point, std::cout);
+    }
+
+    // as above, with the trace written to log instead of std::cout
+    auto InPolygonTest(const POINTTYPE &point, std::ostream &log) const -> std::string
+    {
+        return _enumItemStrings[static_cast<int>(Classify(point, &log))];
+    }
+
+    // InPolygonTest without the trace, e.g. for BatchClassify
+    auto Classify(const POINTTYPE &point) const -> PolygonTestResult
+    {
+        return Classify(point, nullptr);
+    }
+
+private:
+    // the trace goes to log unless it is null
+    auto Classify(const POINTTYPE &point, std::ostream *log) const -> PolygonTestResult
+    {
+        POLYGON_TIMED_SCOPE(InPolygonTest, this);
+        POLYGON_COUNT(InPolygonQueries, 1);
         PolygonTestResult ret = PolygonTestResult::UNKNOWN;
         // TODO: implement this function from here and changed the ret to the
         // correct status
@@ -204,11 +283,14 @@ public:
         // If there are less than 3 points, it is not a polygon, return UNKNOWN for
         // simplicity
         if (_pointArray.size() < 3)
-            return _enumItemStrings[static_cast<int>(PolygonTestResult::UNKNOWN)];
+            return PolygonTestResult::UNKNOWN;
 
-        std::cout << point << " in polygon ";
-        PrintPolygon(_pointArray);
-        std::cout << " is ";
+        if (log)
+        {
+            *log << point << " in polygon ";
+            PrintPolygon(_pointArray, *log);
+            *log << " is ";
+        }
 
         // record rightmost, leftmost, topmost, bottommost points, these will be
         // used to create extreme horizontal and vertical rays
@@ -216,24 +298,27 @@ public:
         // loop through all adjacent segments
         for (auto i = 0; i < _pointArray.size(); ++i)
         {
+            POLYGON_COUNT(EdgesVisited, 1);
             max_x = std::max(max_x, get_x(_pointArray[i]));
             min_x = std::min(min_x, get_x(_pointArray[i]));
             max_y = std::max(max_y, get_y(_pointArray[i]));
             min_y = std::min(min_y, get_y(_pointArray[i]));
 
-            auto intersections = std::vector<POINTTYPE>();
+            auto intersections = SegmentIntersectionPoints<POINTTYPE>();
             SegmentIntersection(_pointArray[i], _pointArray[(i + 1) % _pointArray.size()], _pointArray[(i + 1) % _pointArray.size()], _pointArray[(i + 2) % _pointArray.size()], intersections);
             // if two adjacent segments overlap, return UNKNOWN as this is not a standard polygon
             if (intersections.size() != 1)
             {
-                std::cout << "UNKNOWN" << " size: " << intersections.size() << std::endl;
-                return _enumItemStrings[static_cast<int>(PolygonTestResult::UNKNOWN)];
+                if (log)
+                    *log << "UNKNOWN" << " size: " << intersections.size() << std::endl;
+                return PolygonTestResult::UNKNOWN;
             }
             // if the point is on the segment, return OnPolygonEdge
             if (OnSegment(point, _pointArray[i], _pointArray[(i + 1) % _pointArray.size()]))
             {
-                std::cout << "OnPolygonEdge" << std::endl;
-                return _enumItemStrings[static_cast<int>(PolygonTestResult::OnPolygonEdge)];
+                if (log)
+                    *log << "OnPolygonEdge" << std::endl;
+                return PolygonTestResult::OnPolygonEdge;
             }
         }
 
@@ -242,24 +327,23 @@ public:
         POINTTYPE negative_x_extreme(create_min(min_x), get_y(point)); // negative x direction ray
         POINTTYPE negative_y_extreme(get_x(point), create_min(min_y)); // negative y direction ray
         
-        std::vector<POINTTYPE> extreme_points{positive_x_extreme, positive_y_extreme, negative_x_extreme, negative_y_extreme};
+        std::array<POINTTYPE, 4> extreme_points{positive_x_extreme, positive_y_extreme, negative_x_extreme, negative_y_extreme};
 
         // a flag to keep track if there is no intersection for a raoy
         bool no_intersections = false;
         // loop through 4 rays
         for (auto i = 0; i < extreme_points.size(); ++i)
         {
-            auto intersections_with_a_ray = std::set<POINTTYPE>();
+            // only whether the ray hits the polygon at all matters
+            auto ray_hits_polygon = false;
+            POLYGON_COUNT(EdgesVisited, _pointArray.size());
             for (auto j = 0; j < _pointArray.size(); ++j)
             {
-                auto intersections = std::vector<POINTTYPE>();
+                auto intersections = SegmentIntersectionPoints<POINTTYPE>();
                 SegmentIntersection(_pointArray[j], _pointArray[(j + 1) % _pointArray.size()], point, extreme_points[i], intersections);
-                for (auto intersection : intersections)
-                {
-                    intersections_with_a_ray.insert(intersection);
-                }
+                ray_hits_polygon = ray_hits_polygon || !intersections.empty();
             }
-            if (intersections_with_a_ray.empty())
+            if (!ray_hits_polygon)
             {
                 no_intersections = true;
             }
@@ -270,84 +354,276 @@ public:
         } else {
             ret = PolygonTestResult::InPolygon;
         }
-        std::cout << _enumItemStrings[static_cast<int>(ret)] << std::endl;
-        return _enumItemStrings[static_cast<int>(ret)];
+        if (log)
+            *log << _enumItemStrings[static_cast<int>(ret)] << std::endl;
+        return ret;
     }
 
+public:
 
-    auto ClipSegments(const POINTARRAY &tobeclippedpath, POINTARRAY &clipped)
+    // the temporary intersection buffer comes from resource, e.g. a
+    // std::pmr::monotonic_buffer_resource released per batch avoids any malloc call
+    auto ClipSegments(const POINTARRAY &tobeclippedpath, POINTARRAY &clipped,
+                      std::pmr::memory_resource *resource = std::pmr::get_default_resource())
         -> void
     { // tobeclippedpath is the line segment list that adjacent points
       // forms a line segment
-        std::cout << "use ";
-        PrintPolygon(_pointArray);
-        std::cout << " to clip ";
-        PrintPolygon(tobeclippedpath);
+        POLYGON_TIMED_SCOPE(ClipSegments, this);
         // TODO: implement a function to clip segments and return the clipped
         // segments with 'clipped'
 
         // note that the returned size of clipped should be a multiple of 2.
         // clipped[i] and clipped[i + 1] determines a line segment, where i = 0, 2, 4, ...
-        if (_pointArray.size() < 3)
-        {
-            std::cout << "invalid polygon, return now" << std::endl;
+        if (!BeginClip(tobeclippedpath))
             return;
-        }
-        if (tobeclippedpath.size() < 2)
-        {
-            std::cout << "invalid tobeclippedpath input, need to have at least two points, return now" << std::endl;
-            return;
-        }
 
+#ifdef POLYGON_INSTRUMENTATION
+        // the scratch buffer allocations, counted where they happen
+        PolygonCountingResource counting(resource, PolygonCounter::ClipAllocations);
+        resource = &counting;
+#endif
+        // intersections of one path segment, reused across segments
+        auto all_intersections = std::pmr::vector<POINTTYPE>{resource};
         // loop through all the segments in tobeclippedpath
         for (auto i = 0; i < tobeclippedpath.size() - 1; ++i)
         {
-            auto start_point = tobeclippedpath[i], end_point = tobeclippedpath[i + 1];
-            auto start_status = InPolygonTest(start_point),
-                 end_status = InPolygonTest(end_point);
+            ClipPathSegment(tobeclippedpath[i], tobeclippedpath[i + 1], all_intersections, clipped);
+        }
+        EndClip(clipped);
+    }
 
-            if (start_status == "UNKNOWN" || end_status == "UNKNOWN")
-            {
-                std::cout << "invalid polygon provided, continue";
-                continue;
-            }
+    /**
+     * @brief ClipSegments with the path segments spread over worker threads.
+     *
+     * The path is cut into chunks of up to CLIPCHUNKSEGMENTS consecutive segments, claimed by
+     * the workers in order. Every chunk is clipped into its own buffer and trace stream, and
+     * written out (trace to std::cout, points to clipped) as soon as it and all chunks before
+     * it are done, so clipped and the printed trace are identical to those of ClipSegments.
+     * At most 2 * threads chunks are in flight, a worker waits for the output to catch up
+     * before claiming more, which bounds the buffered trace whatever the path length.
+     *
+     * @param resource As for ClipSegments, the workers' intersection buffers come from it.
+     *        Its calls are serialized, so a single threaded arena can be passed as well.
+     * @param threads The number of worker threads, the hardware concurrency by default.
+     */
+    auto ClipSegmentsParallel(const POINTARRAY &tobeclippedpath, POINTARRAY &clipped,
+                              std::pmr::memory_resource *resource = std::pmr::get_default_resource(),
+                              std::size_t threads = std::thread::hardware_concurrency()) -> void
+    {
+        POLYGON_TIMED_SCOPE(ClipSegments, this);
+        if (!BeginClip(tobeclippedpath))
+            return;
 
-            if (start_status == "InPolygon" && end_status == "InPolygon" ||
-                start_status == "OnPolygonEdge" && end_status == "OnPolygonEdge")
-            {
-                clipped.push_back(start_point);
-                clipped.push_back(end_point);
-                continue;
-            }
+        struct Chunk
+        {
+            std::vector<POINTTYPE> clipped;
+            std::ostringstream log;
+            bool ready = false;
+        };
+        const std::size_t segments = tobeclippedpath.size() - 1;
+        const auto chunk_count = (segments + CLIPCHUNKSEGMENTS - 1) / CLIPCHUNKSEGMENTS;
+        threads = std::max<std::size_t>(1, std::min(threads, chunk_count));
+        // chunk c is buffered in window[c % window.size()] until it is written out
+        std::vector<Chunk> window(2 * threads);
+        std::mutex mutex;
+        std::condition_variable window_freed;
+        SynchronizedResource synchronized(resource);
+        std::size_t next_chunk = 0, written = 0;
+        bool writing = false;
 
-            auto all_intersections = std::set<POINTTYPE>{};
-            for (auto j = 0; j < _pointArray.size(); ++j)
+        // the caller holds the lock, one thread at a time writes chunks in order, the lock
+        // is released while writing so the others keep clipping
+        auto write_ready_chunks = [&](std::unique_lock<std::mutex> &lock)
+        {
+            if (writing)
+                return;
+            writing = true;
+            while (written < chunk_count && window[written % window.size()].ready)
             {
-                auto p = _pointArray[j], q = _pointArray[(j + 1) % _pointArray.size()];
-                auto intersections = std::vector<POINTTYPE>{};
-                SegmentIntersection(p, q, start_point, end_point, intersections);
-                for (auto point : intersections)
-                {
-                    all_intersections.insert(point);
-                }
+                auto &chunk = window[written % window.size()];
+                lock.unlock();
+                std::cout << chunk.log.str();
+#ifdef POLYGON_INSTRUMENTATION
+                if constexpr (has_capacity_v<POINTARRAY>)
+                    POLYGON_COUNT(ClipAllocations, clipped.size() + chunk.clipped.size() > clipped.capacity());
+#endif
+                clipped.insert(clipped.end(), chunk.clipped.begin(), chunk.clipped.end());
+                chunk.clipped.clear();
+                chunk.log.str(std::string());
+                lock.lock();
+                chunk.ready = false;
+                ++written;
+                window_freed.notify_all();
             }
+            writing = false;
+        };
 
-            // if one point is inside the polygon and another is outside, we need to
-            // add in the inside point
-            if (start_status == "InPolygon")
-                clipped.push_back(start_point);
-            if (end_status == "InPolygon")
-                clipped.push_back(end_point);
-            for (auto point : all_intersections)
+        auto thread_worker = [&]()
+        {
+#ifdef POLYGON_INSTRUMENTATION
+            PolygonCountingResource counting(&synchronized, PolygonCounter::ClipAllocations);
+            auto all_intersections = std::pmr::vector<POINTTYPE>{&counting};
+#else
+            auto all_intersections = std::pmr::vector<POINTTYPE>{&synchronized};
+#endif
+            std::unique_lock<std::mutex> lock(mutex);
+            while (true)
             {
-                clipped.push_back(point);
+                window_freed.wait(lock, [&]
+                                  { return next_chunk == chunk_count || next_chunk < written + window.size(); });
+                if (next_chunk == chunk_count)
+                    break;
+                auto index = next_chunk++;
+                auto &chunk = window[index % window.size()];
+                lock.unlock();
+                auto end = std::min(segments, (index + 1) * CLIPCHUNKSEGMENTS);
+                for (auto i = index * CLIPCHUNKSEGMENTS; i < end; ++i)
+                    ClipPathSegment(tobeclippedpath[i], tobeclippedpath[i + 1], all_intersections, chunk.clipped, chunk.log);
+                lock.lock();
+                chunk.ready = true;
+                write_ready_chunks(lock);
             }
+        };
+        std::vector<std::thread> workers;
+        for (std::size_t t = 1; t < threads; ++t)
+            workers.emplace_back(thread_worker);
+        thread_worker();
+        for (auto &worker : workers)
+            worker.join();
+        EndClip(clipped);
+    }
+
+    /**
+     * @brief Clips a single path segment, the building block of ClipSegments.
+     *
+     * Appends the clipped points of the segment from `start_point` to `end_point`
+     * to `clipped` in the same order ClipSegments does.
+     *
+     * @tparam OUTPUT A container with push_back.
+     * @param start_point The start point of the path segment.
+     * @param end_point The end point of the path segment.
+     * @param all_intersections Scratch buffer, reused between calls to avoid allocations.
+     * @param clipped The container that receives the clipped points.
+     * @param log Receives the trace of the point tests.
+     */
+    template <typename OUTPUT>
+    auto ClipPathSegment(const POINTTYPE &start_point, const POINTTYPE &end_point,
+                         std::pmr::vector<POINTTYPE> &all_intersections, OUTPUT &clipped,
+                         std::ostream &log = std::cout) const -> void
+    {
+        POLYGON_COUNT(ClippedPathSegments, 1);
+        auto start_status = InPolygonTest(start_point, log),
+             end_status = InPolygonTest(end_point, log);
+
+        if (start_status == "UNKNOWN" || end_status == "UNKNOWN")
+        {
+            log << "invalid polygon provided, continue";
+            return;
+        }
+
+        if (start_status == "InPolygon" && end_status == "InPolygon" ||
+            start_status == "OnPolygonEdge" && end_status == "OnPolygonEdge")
+        {
+            PushClipped(clipped, start_point);
+            PushClipped(clipped, end_point);
+            return;
         }
+
+        all_intersections.clear();
+        POLYGON_COUNT(EdgesVisited, _pointArray.size());
+        for (auto j = 0; j < _pointArray.size(); ++j)
+        {
+            auto p = _pointArray[j], q = _pointArray[(j + 1) % _pointArray.size()];
+            auto intersections = SegmentIntersectionPoints<POINTTYPE>{};
+            SegmentIntersection(p, q, start_point, end_point, intersections);
+            for (auto point : intersections)
+                all_intersections.push_back(point);
+        }
+        // same order and uniqueness as a std::set<POINTTYPE>
+        std::sort(all_intersections.begin(), all_intersections.end());
+        all_intersections.erase(std::unique(all_intersections.begin(), all_intersections.end(),
+                                            [](const POINTTYPE &a, const POINTTYPE &b)
+                                            { return !(a < b) && !(b < a); }),
+                                all_intersections.end());
+
+        // if one point is inside the polygon and another is outside, we need to
+        // add in the inside point
+        if (start_status == "InPolygon")
+            PushClipped(clipped, start_point);
+        if (end_status == "InPolygon")
+            PushClipped(clipped, end_point);
+        for (auto point : all_intersections)
+        {
+            PushClipped(clipped, point);
+        }
+    }
+
+private:
+    // segments per chunk of ClipSegmentsParallel
+    static constexpr std::size_t CLIPCHUNKSEGMENTS = 64;
+
+    // forwards to upstream under a lock, so the workers of ClipSegmentsParallel can share
+    // a resource that is not thread safe, the scratch buffers only allocate when they grow
+    class SynchronizedResource : public std::pmr::memory_resource
+    {
+    public:
+        explicit SynchronizedResource(std::pmr::memory_resource *upstream) : _upstream(upstream) {}
+
+    private:
+        auto do_allocate(std::size_t bytes, std::size_t alignment) -> void * override
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            return _upstream->allocate(bytes, alignment);
+        }
+        auto do_deallocate(void *pointer, std::size_t bytes, std::size_t alignment) -> void override
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _upstream->deallocate(pointer, bytes, alignment);
+        }
+        auto do_is_equal(const std::pmr::memory_resource &other) const noexcept -> bool override { return this == &other; }
+
+        std::pmr::memory_resource *_upstream;
+        std::mutex _mutex;
+    };
+
+    // the trace and input checks ClipSegments starts with, false if there is nothing to clip
+    auto BeginClip(const POINTARRAY &tobeclippedpath) const -> bool
+    {
+        std::cout << "use ";
+        PrintPolygon(_pointArray);
+        std::cout << " to clip ";
+        PrintPolygon(tobeclippedpath);
+        if (_pointArray.size() < 3)
+        {
+            std::cout << "invalid polygon, return now" << std::endl;
+            return false;
+        }
+        if (tobeclippedpath.size() < 2)
+        {
+            std::cout << "invalid tobeclippedpath input, need to have at least two points, return now" << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+    auto EndClip(const POINTARRAY &clipped) const -> void
+    {
         std::cout << std::endl << " clipped is ";
         PrintPolygon(clipped);
         std::cout << std::endl;
     }
 
-private:
+    // push_back, counting the reallocation of outputs that tell their capacity
+    template <typename OUTPUT>
+    static auto PushClipped(OUTPUT &clipped, const POINTTYPE &point) -> void
+    {
+#ifdef POLYGON_INSTRUMENTATION
+        if constexpr (has_capacity_v<OUTPUT>)
+            POLYGON_COUNT(ClipAllocations, clipped.size() == clipped.capacity());
+#endif
+        POLYGON_COUNT(ClippedPointsPushed, 1);
+        clipped.push_back(point);
+    }
+
     POINTARRAY &_pointArray;
 };
\ No newline at end of file
@@ -0,0 +1,288 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <functional>
+#include <limits>
+#include <string>
+#include <utility>
+#include <vector>
+#include "PolygonT.h"
+
+/**
+ * @brief Levels of detail of a polygon for fast approximate-first classification.
+ *
+ * Each level is a Douglas-Peucker simplification of the source ring at one tolerance,
+ * refined until it has no self intersections. The source boundary stays within the
+ * measured deviation d of the level, so the band of width d around the simplified ring
+ * acts as a conservative inner/outer hull pair: a point farther than d from the level is
+ * classified by the level alone, only points inside the band go to the next finer level
+ * and finally to the full detail ring.
+ *
+ * Like PolygonT the source points are referenced, not copied, and must outlive this object.
+ * The classification is a crossing number test, points within EPSILON of the source
+ * boundary are OnPolygonEdge.
+ *
+ * @tparam POINTARRAY The point container of the source polygon.
+ */
+template <typename POINTARRAY>
+class SimplifiedPolygonT
+{
+public:
+    using POINTTYPE = typename POINTARRAY::value_type;
+
+    struct Level
+    {
+        double tolerance = 0;
+        double deviation = 0; // max distance of the source boundary to this level
+        std::vector<std::size_t> indices; // kept source vertices, in ring order
+        std::vector<double> xs, ys;
+    };
+
+    SimplifiedPolygonT(const POINTARRAY &points, std::vector<double> tolerances) : _pointArray(points)
+    {
+        static_assert(has_indexer_v<POINTARRAY>,
+                      "Template argument must have an indexer");
+        // coarsest level first, it answers most queries
+        std::sort(tolerances.begin(), tolerances.end(), std::greater<double>());
+        if (_pointArray.size() < 3)
+            return;
+        _min_x = _max_x = fix_x(_pointArray[0]);
+        _min_y = _max_y = fix_y(_pointArray[0]);
+        for (std::size_t i = 0; i < _pointArray.size(); ++i)
+        {
+            _min_x = std::min<double>(_min_x, fix_x(_pointArray[i]));
+            _max_x = std::max<double>(_max_x, fix_x(_pointArray[i]));
+            _min_y = std::min<double>(_min_y, fix_y(_pointArray[i]));
+            _max_y = std::max<double>(_max_y, fix_y(_pointArray[i]));
+        }
+        for (auto tolerance : tolerances)
+        {
+            auto level = Simplify(tolerance);
+            // a level that keeps most vertices would not save anything
+            if (level.indices.size() * 2 <= _pointArray.size())
+                _levels.push_back(std::move(level));
+        }
+    }
+
+    auto LevelCount() const -> std::size_t { return _levels.size(); }
+    auto GetLevel(std::size_t i) const -> const Level & { return _levels[i]; }
+
+    auto Classify(const POINTTYPE &point) const -> PolygonTestResult
+    {
+        if (_pointArray.size() < 3)
+            return PolygonTestResult::UNKNOWN;
+        const double x = fix_x(point), y = fix_y(point);
+        if (x < _min_x - EPSILON || x > _max_x + EPSILON || y < _min_y - EPSILON || y > _max_y + EPSILON)
+            return PolygonTestResult::OutsidePolygon;
+
+        for (const auto &level : _levels)
+        {
+            bool on_edge = false, inside = false;
+            auto distance_squared = std::numeric_limits<double>::max();
+            const auto m = level.xs.size();
+            for (std::size_t i = 0; i < m; ++i)
+            {
+                auto j = i + 1 == m ? 0 : i + 1;
+                CrossingNumberStep(level.xs[i], level.ys[i], level.xs[j], level.ys[j], x, y, on_edge, inside);
+                distance_squared = std::min(distance_squared,
+                                            SegmentDistanceSquared(x, y, level.xs[i], level.ys[i], level.xs[j], level.ys[j]));
+            }
+            auto band = level.deviation + EPSILON;
+            if (distance_squared > band * band)
+                return inside ? PolygonTestResult::InPolygon : PolygonTestResult::OutsidePolygon;
+        }
+
+        POLYGON_COUNT(LevelOfDetailFallbacks, 1);
+        bool on_edge = false, inside = false;
+        const auto n = _pointArray.size();
+        for (std::size_t i = 0; i < n; ++i)
+        {
+            const auto &start = _pointArray[i];
+            const auto &end = _pointArray[i + 1 == n ? 0 : i + 1];
+            CrossingNumberStep(fix_x(start), fix_y(start), fix_x(end), fix_y(end), x, y, on_edge, inside);
+        }
+        if (on_edge)
+            return PolygonTestResult::OnPolygonEdge;
+        return inside ? PolygonTestResult::InPolygon : PolygonTestResult::OutsidePolygon;
+    }
+
+    auto InPolygonTest(const POINTTYPE &point) const -> std::string
+    {
+        return _enumItemStrings[static_cast<int>(Classify(point))];
+    }
+
+private:
+    auto X(std::size_t i) const -> double { return fix_x(_pointArray[i % _pointArray.size()]); }
+    auto Y(std::size_t i) const -> double { return fix_y(_pointArray[i % _pointArray.size()]); }
+
+    // the interior source vertex of the span [start, end] farthest from its chord
+    auto Farthest(std::size_t start, std::size_t end) const -> std::pair<std::size_t, double>
+    {
+        std::pair<std::size_t, double> farthest{start, 0.0};
+        for (auto k = start + 1; k < end; ++k)
+        {
+            auto d = SegmentDistanceSquared(X(k), Y(k), X(start), Y(start), X(end), Y(end));
+            if (d > farthest.second)
+                farthest = {k, d};
+        }
+        return farthest;
+    }
+
+    auto Simplify(double tolerance) const -> Level
+    {
+        const auto n = _pointArray.size();
+        // anchor the ring at vertex 0 and the vertex farthest from it, index n stands for 0
+        std::size_t anchor = 1;
+        double anchor_distance = -1;
+        for (std::size_t k = 1; k < n; ++k)
+        {
+            auto dx = X(k) - X(0), dy = Y(k) - Y(0);
+            if (dx * dx + dy * dy > anchor_distance)
+            {
+                anchor = k;
+                anchor_distance = dx * dx + dy * dy;
+            }
+        }
+
+        std::vector<bool> kept(n + 1, false);
+        kept[0] = kept[anchor] = kept[n] = true;
+        std::vector<std::pair<std::size_t, std::size_t>> spans{{0, anchor}, {anchor, n}};
+        while (!spans.empty())
+        {
+            auto [start, end] = spans.back();
+            spans.pop_back();
+            auto [k, d] = Farthest(start, end);
+            if (k != start && d > tolerance * tolerance)
+            {
+                kept[k] = true;
+                spans.push_back({start, k});
+                spans.push_back({k, end});
+            }
+        }
+
+        // a triangle at least, then split edges until the ring does not touch itself
+        while (true)
+        {
+            auto indices = KeptIndices(kept);
+            std::vector<std::size_t> split;
+            if (indices.size() < 4)
+            {
+                split = {0, 1};
+            }
+            else
+            {
+                split = IntersectingEdges(indices);
+            }
+            auto refined = false;
+            for (auto e : split)
+            {
+                auto [k, d] = Farthest(indices[e], indices[e + 1]);
+                if (k != indices[e])
+                {
+                    kept[k] = true;
+                    refined = true;
+                }
+            }
+            if (!refined)
+                break;
+        }
+
+        Level level;
+        level.tolerance = tolerance;
+        auto indices = KeptIndices(kept);
+        for (std::size_t e = 0; e + 1 < indices.size(); ++e)
+        {
+            auto d = Farthest(indices[e], indices[e + 1]).second;
+            level.deviation = std::max(level.deviation, d);
+        }
+        level.deviation = std::sqrt(level.deviation);
+        indices.pop_back(); // n, the closing copy of vertex 0
+        for (auto i : indices)
+        {
+            level.indices.push_back(i);
+            level.xs.push_back(X(i));
+            level.ys.push_back(Y(i));
+        }
+        return level;
+    }
+
+    // kept vertices in ring order, ending with n
+    static auto KeptIndices(const std::vector<bool> &kept) -> std::vector<std::size_t>
+    {
+        std::vector<std::size_t> indices;
+        for (std::size_t i = 0; i < kept.size(); ++i)
+            if (kept[i])
+                indices.push_back(i);
+        return indices;
+    }
+
+    static auto Orientation(double ax, double ay, double bx, double by, double cx, double cy) -> int
+    {
+        auto cross = (bx - ax) * (cy - ay) - (by - ay) * (cx - ax);
+        return cross > 0 ? 1 : (cross < 0 ? -1 : 0);
+    }
+
+    // edges e (from indices[e] to indices[e + 1]) that touch a non adjacent edge or fold
+    // back onto their neighbour, found with a sweep over the x extents of the edges
+    auto IntersectingEdges(const std::vector<std::size_t> &indices) const -> std::vector<std::size_t>
+    {
+        const auto m = indices.size() - 1;
+        std::vector<std::size_t> order(m);
+        for (std::size_t e = 0; e < m; ++e)
+            order[e] = e;
+        auto min_x = [&](std::size_t e) { return std::min(X(indices[e]), X(indices[e + 1])); };
+        auto max_x = [&](std::size_t e) { return std::max(X(indices[e]), X(indices[e + 1])); };
+        std::sort(order.begin(), order.end(), [&](std::size_t a, std::size_t b) { return min_x(a) < min_x(b); });
+
+        std::vector<bool> flagged(m, false);
+        for (std::size_t a = 0; a < m; ++a)
+        {
+            auto e = order[a];
+            for (auto b = a + 1; b < m && min_x(order[b]) <= max_x(e); ++b)
+            {
+                auto f = order[b];
+                if (EdgesConflict(indices, e, f))
+                    flagged[e] = flagged[f] = true;
+            }
+        }
+        std::vector<std::size_t> result;
+        for (std::size_t e = 0; e < m; ++e)
+            if (flagged[e])
+                result.push_back(e);
+        return result;
+    }
+
+    auto EdgesConflict(const std::vector<std::size_t> &indices, std::size_t e, std::size_t f) const -> bool
+    {
+        const auto m = indices.size() - 1;
+        auto ax = X(indices[e]), ay = Y(indices[e]), bx = X(indices[e + 1]), by = Y(indices[e + 1]);
+        auto cx = X(indices[f]), cy = Y(indices[f]), dx = X(indices[f + 1]), dy = Y(indices[f + 1]);
+        if (std::max(ay, by) < std::min(cy, dy) || std::max(cy, dy) < std::min(ay, by))
+            return false;
+        auto adjacent = f == e + 1 || e == f + 1 || (e == 0 && f == m - 1) || (f == 0 && e == m - 1);
+        if (adjacent)
+        {
+            // sharing a vertex is fine, running back along the other edge is not
+            auto cross = (bx - ax) * (dy - cy) - (by - ay) * (dx - cx);
+            auto dot = (bx - ax) * (dx - cx) + (by - ay) * (dy - cy);
+            return cross == 0 && dot < 0;
+        }
+        auto o1 = Orientation(ax, ay, bx, by, cx, cy), o2 = Orientation(ax, ay, bx, by, dx, dy);
+        auto o3 = Orientation(cx, cy, dx, dy, ax, ay), o4 = Orientation(cx, cy, dx, dy, bx, by);
+        if (o1 != o2 && o3 != o4)
+            return true;
+        // collinear touching
+        auto within = [](double px, double py, double sx, double sy, double ex, double ey)
+        {
+            return std::min(sx, ex) <= px && px <= std::max(sx, ex) && std::min(sy, ey) <= py && py <= std::max(sy, ey);
+        };
+        return (o1 == 0 && within(cx, cy, ax, ay, bx, by)) || (o2 == 0 && within(dx, dy, ax, ay, bx, by)) ||
+               (o3 == 0 && within(ax, ay, cx, cy, dx, dy)) || (o4 == 0 && within(bx, by, cx, cy, dx, dy));
+    }
+
+    const POINTARRAY &_pointArray;
+    std::vector<Level> _levels;
+    double _min_x = 0, _max_x = 0, _min_y = 0, _max_y = 0;
+};
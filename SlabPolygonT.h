@@ -0,0 +1,169 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "PolygonT.h"
+
+/**
+ * @brief A polygon bucketed into horizontal slabs for repeated point queries.
+ *
+ * The bbox height is split into equal slabs, and every slab keeps a contiguous copy of the
+ * edges that reach into it (widened by EPSILON). A query only runs the crossing number test
+ * over the edges of its slab, with the same result as testing all edges.
+ *
+ * Tall edges are copied into every slab they span, so the slab count is chosen from the
+ * edge heights to keep the copies within MAXCOPIES * n. Polygons of mostly tall edges (e.g.
+ * a sawtooth) get few slabs and degrade towards the full edge scan, not to O(n^2) memory.
+ *
+ * Spatially sorted batches (see BatchClassify) mostly revisit the slab of the previous query,
+ * whose edges are then still in cache. Consecutive queries can also pass a QueryHint that
+ * remembers the last slab, but SlabOf is a floor division already and the hint saves little.
+ *
+ * @tparam POINTTYPE The type representing a point.
+ */
+template <typename POINTTYPE>
+class SlabPolygonT
+{
+public:
+    struct QueryHint
+    {
+        std::size_t slab = SIZE_MAX;
+    };
+
+    template <typename POINTARRAY>
+    explicit SlabPolygonT(const POINTARRAY &points)
+    {
+        static_assert(has_indexer_v<POINTARRAY>,
+                      "Template argument must have an indexer");
+        const auto n = points.size();
+        if (n < 3)
+            return;
+        std::vector<Edge> edges(n);
+        _min_x = _max_x = fix_x(points[0]);
+        _min_y = _max_y = fix_y(points[0]);
+        double total_height = 0;
+        for (std::size_t i = 0; i < n; ++i)
+        {
+            edges[i] = {static_cast<double>(fix_x(points[i])), static_cast<double>(fix_y(points[i])),
+                        static_cast<double>(fix_x(points[(i + 1) % n])), static_cast<double>(fix_y(points[(i + 1) % n]))};
+            _min_x = std::min(_min_x, edges[i].start_x);
+            _max_x = std::max(_max_x, edges[i].start_x);
+            _min_y = std::min(_min_y, edges[i].start_y);
+            _max_y = std::max(_max_y, edges[i].start_y);
+            total_height += std::abs(edges[i].end_y - edges[i].start_y) + 2 * EPSILON;
+        }
+        // an edge of height h spans about h / slab height + 1 slabs, so the copies are about
+        // slab count * total height / bbox height + n
+        const auto height = _max_y - _min_y;
+        const auto budget = static_cast<double>(MAXCOPIES - 1) * n * height / total_height;
+        _slab_count = static_cast<std::size_t>(std::clamp(std::min(budget, n / 2.0), 1.0, double(1 << 20)));
+
+        // two passes, count then fill, so each slab is one contiguous run of edges; the
+        // estimate ignores rounding at slab borders, fewer slabs are used if it was off
+        while (true)
+        {
+            _slab_height = height > 0 ? height / _slab_count : 1;
+            _offsets.assign(_slab_count + 1, 0);
+            for (const auto &edge : edges)
+            {
+                auto [first, last] = SlabRange(edge);
+                _offsets[first + 1] += 1;
+                if (last + 1 < _slab_count)
+                    _offsets[last + 1 + 1] -= 1;
+            }
+            // the +1 / -1 marks summed up give the count per slab
+            for (std::size_t s = 1; s <= _slab_count; ++s)
+                _offsets[s] += _offsets[s - 1];
+            std::size_t copies = 0;
+            for (std::size_t s = 1; s <= _slab_count; ++s)
+                copies += _offsets[s];
+            if (copies <= MAXCOPIES * n || _slab_count == 1)
+                break;
+            _slab_count = (_slab_count + 1) / 2;
+        }
+        for (std::size_t s = 0; s < _slab_count; ++s)
+            _offsets[s + 1] += _offsets[s];
+        _slab_edges.resize(_offsets.back());
+        auto fill = _offsets;
+        for (const auto &edge : edges)
+        {
+            auto [first, last] = SlabRange(edge);
+            for (auto s = first; s <= last; ++s)
+                _slab_edges[fill[s]++] = edge;
+        }
+    }
+
+    auto Classify(const POINTTYPE &point) const -> PolygonTestResult
+    {
+        QueryHint hint;
+        return Classify(point, hint);
+    }
+
+    auto Classify(const POINTTYPE &point, QueryHint &hint) const -> PolygonTestResult
+    {
+        if (_offsets.empty())
+            return PolygonTestResult::UNKNOWN;
+        const double x = fix_x(point), y = fix_y(point);
+        if (x < _min_x - EPSILON || x > _max_x + EPSILON || y < _min_y - EPSILON || y > _max_y + EPSILON)
+            return PolygonTestResult::OutsidePolygon;
+        // the remembered slab is reused as long as the point falls into it
+        if (hint.slab >= _slab_count || y < SlabBottom(hint.slab) || y >= SlabBottom(hint.slab + 1))
+            hint.slab = SlabOf(y);
+        bool on_edge = false, inside = false;
+        for (auto i = _offsets[hint.slab]; i < _offsets[hint.slab + 1]; ++i)
+        {
+            const auto &edge = _slab_edges[i];
+            CrossingNumberStep(edge.start_x, edge.start_y, edge.end_x, edge.end_y, x, y, on_edge, inside);
+        }
+        if (on_edge)
+            return PolygonTestResult::OnPolygonEdge;
+        return inside ? PolygonTestResult::InPolygon : PolygonTestResult::OutsidePolygon;
+    }
+
+    auto InPolygonTest(const POINTTYPE &point) const -> std::string
+    {
+        return _enumItemStrings[static_cast<int>(Classify(point))];
+    }
+
+    auto SlabCount() const -> std::size_t { return _slab_count; }
+
+private:
+    static constexpr std::size_t MAXCOPIES = 4;
+
+    struct Edge
+    {
+        double start_x, start_y, end_x, end_y;
+    };
+
+    auto SlabBottom(std::size_t slab) const -> double
+    {
+        return slab == 0 ? -HUGE_VAL : (slab >= _slab_count ? HUGE_VAL : _min_y + slab * _slab_height);
+    }
+
+    auto SlabOf(double y) const -> std::size_t
+    {
+        auto slab = static_cast<std::size_t>(std::clamp(std::floor((y - _min_y) / _slab_height), 0.0,
+                                                        static_cast<double>(_slab_count - 1)));
+        // floor may be off by one against SlabBottom, which decides the membership
+        while (slab > 0 && y < SlabBottom(slab))
+            --slab;
+        while (slab + 1 < _slab_count && y >= SlabBottom(slab + 1))
+            ++slab;
+        return slab;
+    }
+
+    auto SlabRange(const Edge &edge) const -> std::pair<std::size_t, std::size_t>
+    {
+        return {SlabOf(std::min(edge.start_y, edge.end_y) - EPSILON), SlabOf(std::max(edge.start_y, edge.end_y) + EPSILON)};
+    }
+
+    std::vector<Edge> _slab_edges;
+    std::vector<std::size_t> _offsets;
+    std::size_t _slab_count = 0;
+    double _slab_height = 1;
+    double _min_x = 0, _max_x = 0, _min_y = 0, _max_y = 0;
+};
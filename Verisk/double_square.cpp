@@ -0,0 +1,114 @@
+#include <cerrno>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "double_square.hpp"
+
+// DoubleSquare.exe, counts the ways N can be written as the sum of two squares.
+// To compile with g++:
+//     g++ -std=c++17 -O2 -pthread -o DoubleSquare.exe double_square.cpp
+// Usage:
+//     DoubleSquare.exe N [N ...]                 list the representations of each N
+//     DoubleSquare.exe                           read N values from stdin, print the counts
+//     DoubleSquare.exe --range LO HI [THREADS]   count the ways for every N in [LO, HI]
+//     DoubleSquare.exe --range LO HI [THREADS] --print
+//                                                same, printing "N ways" for every double square
+
+using double_square::u64;
+
+bool parse_number(const char *text, u64 &value) {
+  if (!text || !*text || *text == '-')
+    return false;
+  char *end = nullptr;
+  errno = 0;
+  value = std::strtoull(text, &end, 10);
+  // strtoull saturates at 2^64 - 1 on overflow
+  return *end == '\0' && errno != ERANGE;
+}
+
+void print_usage(const char *name) {
+  std::cout << "Usage: " << name << " N [N ...]" << std::endl
+            << "       " << name << " --range LO HI [THREADS] [--print]" << std::endl
+            << "       " << name << " < numbers.txt" << std::endl;
+}
+
+int run_range(int argc, char *argv[]) {
+  u64 lo = 0, hi = 0, threads = std::thread::hardware_concurrency();
+  bool print = false;
+  std::vector<std::string> args(argv + 2, argv + argc);
+  if (!args.empty() && args.back() == "--print") {
+    print = true;
+    args.pop_back();
+  }
+  if (args.size() < 2 || args.size() > 3 || !parse_number(args[0].c_str(), lo) || !parse_number(args[1].c_str(), hi) ||
+      (args.size() == 3 && !parse_number(args[2].c_str(), threads)) || hi < lo) {
+    print_usage(argv[0]);
+    return 1;
+  }
+
+  std::atomic<u64> total_ways{0}, double_squares{0};
+  std::mutex output_mutex;
+  auto start = std::chrono::steady_clock::now();
+  double_square::count_ways_range(
+      lo, hi,
+      [&](u64 segment_lo, const std::vector<u64> &ways) {
+        u64 sum = 0, hits = 0;
+        for (auto w : ways) {
+          sum += w;
+          hits += w > 0;
+        }
+        total_ways += sum;
+        double_squares += hits;
+        if (print) {
+          // segments finish out of order, keep each segment in one block
+          std::lock_guard<std::mutex> lock(output_mutex);
+          for (size_t i = 0; i < ways.size(); ++i)
+            if (ways[i])
+              std::cout << segment_lo + i << " " << ways[i] << "\n";
+        }
+      },
+      static_cast<unsigned>(threads));
+  auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+  std::cout << "range [" << lo << ", " << hi << "]: " << double_squares << " double squares, " << total_ways
+            << " representations in total, " << elapsed << " s" << std::endl;
+  return 0;
+}
+
+int main(int argc, char *argv[]) {
+  if (argc >= 2 && std::string(argv[1]) == "--range")
+    return run_range(argc, argv);
+
+  if (argc == 1) {
+    // batch mode, one N per whitespace separated token
+    std::string token;
+    while (std::cin >> token) {
+      u64 n = 0;
+      if (!parse_number(token.c_str(), n)) {
+        std::cerr << "Error: skip invalid input " << token << std::endl;
+        continue;
+      }
+      std::cout << n << " " << double_square::count_ways(n) << "\n";
+    }
+    return 0;
+  }
+
+  for (int i = 1; i < argc; ++i) {
+    u64 n = 0;
+    if (!parse_number(argv[i], n)) {
+      print_usage(argv[0]);
+      return 1;
+    }
+    auto res = double_square::representations(n);
+    if (res.empty()) {
+      std::cout << n << ": No solution" << std::endl;
+      continue;
+    }
+    for (auto &p : res)
+      std::cout << n << " = " << p.first << "^2 + " << p.second << "^2" << std::endl;
+  }
+  return 0;
+}
@@ -0,0 +1,419 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <numeric>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// Double-square counting based on the sum of two squares theorem:
+//   N = 2^a * prod(p_i^b_i) * prod(q_j^c_j), p_i = 1 (mod 4), q_j = 3 (mod 4)
+// N is a sum of two squares iff every c_j is even, and with B = prod(b_i + 1)
+// the number of unordered representations N = x^2 + y^2, 0 <= x <= y is ceil(B / 2).
+// All arithmetic is done on uint64_t with 128 bit intermediates, so any N < 2^64 is safe.
+namespace double_square {
+
+using u64 = uint64_t;
+using u128 = unsigned __int128;
+
+inline u64 mul_mod(u64 a, u64 b, u64 m) {
+  return static_cast<u64>(static_cast<u128>(a) * b % m);
+}
+
+inline u64 pow_mod(u64 base, u64 exp, u64 m) {
+  u64 result = 1 % m;
+  base %= m;
+  while (exp) {
+    if (exp & 1)
+      result = mul_mod(result, base, m);
+    base = mul_mod(base, base, m);
+    exp >>= 1;
+  }
+  return result;
+}
+
+// floor(sqrt(n)) without the rounding errors of the double version
+inline u64 isqrt(u64 n) {
+  u64 r = static_cast<u64>(std::sqrt(static_cast<double>(n)));
+  while (r > 0 && static_cast<u128>(r) * r > n)
+    --r;
+  while (static_cast<u128>(r + 1) * (r + 1) <= n)
+    ++r;
+  return r;
+}
+
+// simple sieve of Eratosthenes, returns all primes <= limit
+inline std::vector<uint32_t> prime_sieve(uint32_t limit) {
+  std::vector<uint32_t> primes;
+  if (limit < 2)
+    return primes;
+  std::vector<bool> composite(limit + 1, false);
+  for (u64 i = 2; i <= limit; ++i) {
+    if (composite[i])
+      continue;
+    primes.push_back(static_cast<uint32_t>(i));
+    for (u64 j = i * i; j <= limit; j += i)
+      composite[j] = true;
+  }
+  return primes;
+}
+
+// Montgomery arithmetic modulo an odd n, values are kept as x * 2^64 mod n.
+// A product costs two 64 x 64 bit multiplies instead of a 128 bit division.
+struct montgomery {
+  u64 n, inv, one;
+
+  explicit montgomery(u64 modulus) : n(modulus), inv(modulus) {
+    // Newton iteration for n^-1 mod 2^64, every step doubles the correct low bits
+    for (int i = 0; i < 5; ++i)
+      inv *= 2 - n * inv;
+    one = to(1);
+  }
+
+  u64 to(u64 a) const { return static_cast<u64>((static_cast<u128>(a % n) << 64) % n); }
+
+  // t * 2^-64 mod n for t < n * 2^64, the low halves of t and m * n cancel exactly
+  u64 reduce(u128 t) const {
+    u64 m = static_cast<u64>(t) * inv;
+    u64 t_hi = static_cast<u64>(t >> 64), mn_hi = static_cast<u64>((static_cast<u128>(m) * n) >> 64);
+    return t_hi >= mn_hi ? t_hi - mn_hi : t_hi + (n - mn_hi);
+  }
+
+  u64 mul(u64 a, u64 b) const { return reduce(static_cast<u128>(a) * b); }
+  u64 add(u64 a, u64 b) const { return a >= n - b ? a - (n - b) : a + b; }
+
+  u64 pow(u64 base, u64 exp) const {
+    u64 result = one;
+    while (exp) {
+      if (exp & 1)
+        result = mul(result, base);
+      base = mul(base, base);
+      exp >>= 1;
+    }
+    return result;
+  }
+};
+
+// deterministic Miller-Rabin for all 64 bit integers
+inline bool is_prime(u64 n) {
+  if (n < 2)
+    return false;
+  for (u64 p : {2, 3, 5, 7, 11, 13, 17, 19, 23, 29, 31, 37}) {
+    if (n % p == 0)
+      return n == p;
+  }
+  u64 d = n - 1;
+  int s = 0;
+  while ((d & 1) == 0) {
+    d >>= 1;
+    ++s;
+  }
+  const montgomery mont(n);
+  const u64 minus_one = n - mont.one;
+  for (u64 a : {2, 3, 5, 7, 11, 13, 17, 19, 23, 29, 31, 37}) {
+    u64 x = mont.pow(mont.to(a), d);
+    if (x == mont.one || x == minus_one)
+      continue;
+    bool witness = true;
+    for (int r = 1; r < s && witness; ++r) {
+      x = mont.mul(x, x);
+      if (x == minus_one)
+        witness = false;
+    }
+    if (witness)
+      return false;
+  }
+  return true;
+}
+
+// Pollard-Brent rho, returns a non trivial factor of the composite n
+inline u64 pollard_rho(u64 n) {
+  if (n % 2 == 0)
+    return 2;
+  // iterating in Montgomery form is still a polynomial map mod n, and the
+  // factor 2^64 of every difference is coprime to n, so the gcds are unchanged
+  const montgomery mont(n);
+  for (u64 c = 1;; ++c) {
+    auto f = [&](u64 x) { return mont.add(mont.mul(x, x), c % n); };
+    u64 x = mont.to(2), y = x, q = mont.one, g = 1, ys = x;
+    u64 r = 1;
+    constexpr u64 batch = 128;
+    do {
+      x = y;
+      for (u64 i = 0; i < r; ++i)
+        y = f(y);
+      for (u64 k = 0; k < r && g == 1; k += batch) {
+        ys = y;
+        for (u64 i = 0; i < std::min(batch, r - k); ++i) {
+          y = f(y);
+          q = mont.mul(q, x > y ? x - y : y - x);
+        }
+        g = std::gcd(q, n);
+      }
+      r <<= 1;
+    } while (g == 1);
+    if (g == n) {
+      // the batched product overshot, step back one at a time
+      do {
+        ys = f(ys);
+        g = std::gcd(x > ys ? x - ys : ys - x, n);
+      } while (g == 1);
+    }
+    if (g != n)
+      return g;
+  }
+}
+
+// Splits n with Miller-Rabin and Pollard rho only, adding its prime factors to factors.
+// Meant for cofactors that are known to have no small factor, rho is slow to find those.
+inline void factorize_rough(u64 n, std::vector<std::pair<u64, int>> &factors) {
+  std::vector<u64> stack;
+  if (n > 1)
+    stack.push_back(n);
+  while (!stack.empty()) {
+    u64 m = stack.back();
+    stack.pop_back();
+    if (is_prime(m)) {
+      auto it = std::find_if(factors.begin(), factors.end(), [m](const auto &f) { return f.first == m; });
+      if (it != factors.end())
+        ++it->second;
+      else
+        factors.push_back({m, 1});
+      continue;
+    }
+    u64 d = pollard_rho(m);
+    stack.push_back(d);
+    stack.push_back(m / d);
+  }
+}
+
+// prime factorization as (prime, exponent) pairs sorted by prime
+inline std::vector<std::pair<u64, int>> factorize(u64 n) {
+  static const std::vector<uint32_t> small_primes = prime_sieve(1 << 16);
+  std::vector<std::pair<u64, int>> factors;
+  if (n < 2)
+    return factors;
+  for (auto p : small_primes) {
+    if (static_cast<u64>(p) * p > n)
+      break;
+    if (n % p)
+      continue;
+    int e = 0;
+    while (n % p == 0) {
+      n /= p;
+      ++e;
+    }
+    factors.push_back({p, e});
+  }
+  // everything left has no factor below 2^16
+  factorize_rough(n, factors);
+  std::sort(factors.begin(), factors.end());
+  return factors;
+}
+
+// B = prod(b_i + 1) over primes = 1 (mod 4), 0 if some prime = 3 (mod 4) has an odd exponent
+inline u64 divisor_product(const std::vector<std::pair<u64, int>> &factors) {
+  u64 b = 1;
+  for (auto &[p, e] : factors) {
+    if (p % 4 == 3 && (e & 1))
+      return 0;
+    if (p % 4 == 1)
+      b *= static_cast<u64>(e) + 1;
+  }
+  return b;
+}
+
+inline u64 ways_from_product(u64 b) {
+  return (b + 1) / 2;
+}
+
+// number of ways n can be written as x^2 + y^2 with 0 <= x <= y
+inline u64 count_ways(u64 n) {
+  if (n == 0)
+    return 1;
+  return ways_from_product(divisor_product(factorize(n)));
+}
+
+// Gaussian integer helpers used to list the representations
+struct gaussian {
+  __int128 re, im;
+};
+
+inline gaussian operator*(const gaussian &a, const gaussian &b) {
+  return {a.re * b.re - a.im * b.im, a.re * b.im + a.im * b.re};
+}
+
+// Cornacchia: for a prime p = 1 (mod 4) return (a, b) with a^2 + b^2 = p
+inline std::pair<u64, u64> two_squares_of_prime(u64 p) {
+  u64 t = 0;
+  for (u64 c = 2;; ++c) {
+    // c is a quadratic non residue iff c^((p-1)/2) = -1, then c^((p-1)/4) is sqrt(-1)
+    if (pow_mod(c, (p - 1) / 2, p) == p - 1) {
+      t = pow_mod(c, (p - 1) / 4, p);
+      break;
+    }
+  }
+  u64 r0 = p, r1 = t;
+  while (static_cast<u128>(r1) * r1 > p) {
+    u64 r2 = r0 % r1;
+    r0 = r1;
+    r1 = r2;
+  }
+  return {r1, isqrt(p - r1 * r1)};
+}
+
+// all representations n = x^2 + y^2 with 0 <= x <= y, sorted by x
+inline std::vector<std::pair<u64, u64>> representations(u64 n) {
+  if (n == 0)
+    return {{0, 0}};
+  auto factors = factorize(n);
+  if (divisor_product(factors) == 0)
+    return {};
+
+  // the part that does not depend on the choice of conjugates
+  gaussian fixed{1, 0};
+  std::vector<std::pair<gaussian, int>> splitting;
+  for (auto &[p, e] : factors) {
+    if (p == 2) {
+      for (int k = 0; k < e; ++k)
+        fixed = fixed * gaussian{1, 1};
+    } else if (p % 4 == 3) {
+      for (int k = 0; k < e / 2; ++k)
+        fixed = fixed * gaussian{static_cast<__int128>(p), 0};
+    } else {
+      auto [a, b] = two_squares_of_prime(p);
+      splitting.push_back({gaussian{static_cast<__int128>(a), static_cast<__int128>(b)}, e});
+    }
+  }
+
+  std::vector<std::pair<u64, u64>> result;
+  std::function<void(size_t, gaussian)> expand = [&](size_t idx, gaussian g) {
+    if (idx == splitting.size()) {
+      u64 x = static_cast<u64>(g.re < 0 ? -g.re : g.re);
+      u64 y = static_cast<u64>(g.im < 0 ? -g.im : g.im);
+      result.push_back({std::min(x, y), std::max(x, y)});
+      return;
+    }
+    auto [pi, e] = splitting[idx];
+    gaussian conj{pi.re, -pi.im};
+    // pi^j * conj^(e-j) for j = 0..e
+    for (int j = 0; j <= e; ++j) {
+      gaussian term = g;
+      for (int k = 0; k < j; ++k)
+        term = term * pi;
+      for (int k = j; k < e; ++k)
+        term = term * conj;
+      expand(idx + 1, term);
+    }
+  };
+  expand(0, fixed);
+  std::sort(result.begin(), result.end());
+  result.erase(std::unique(result.begin(), result.end()), result.end());
+  return result;
+}
+
+// Segmented sieve that computes count_ways for every n in [lo, lo + len).
+// When base_primes covers sqrt(lo + len - 1) every remaining cofactor is a prime, otherwise
+// cofactors above the square of the largest base prime fall back to factorize_rough(), as
+// they have no factor up to the largest base prime.
+inline void count_ways_segment(u64 lo, u64 len, const std::vector<uint32_t> &base_primes, std::vector<u64> &ways) {
+  ways.assign(len, 1);
+  std::vector<u64> done(len, 1);     // product of the prime powers found so far
+  std::vector<uint32_t> stamp(len, 0); // last prime that touched the slot
+  const u64 hi = lo + len - 1;
+  const u128 covered = base_primes.empty() ? 1 : static_cast<u128>(base_primes.back()) * base_primes.back();
+
+  for (auto p32 : base_primes) {
+    const u64 p = p32;
+    if (p * p > hi)
+      break;
+    // highest power of p that can appear in the segment
+    u64 top = p;
+    int levels = 1;
+    while (top <= hi / p) {
+      top *= p;
+      ++levels;
+    }
+    // walk from the highest power down, so every slot sees its exact exponent first
+    u64 pk = top;
+    for (int k = levels; k >= 1; --k, pk /= p) {
+      // offset of the first multiple of pk, lo + pk - 1 could wrap around 2^64
+      const u64 offset = lo % pk ? pk - lo % pk : 0;
+      for (u64 i = offset; i < len; i = pk < len - i ? i + pk : len) {
+        if (stamp[i] == p32)
+          continue;
+        stamp[i] = p32;
+        done[i] *= pk;
+        if (p % 4 == 1)
+          ways[i] *= static_cast<u64>(k) + 1;
+        else if (p % 4 == 3 && (k & 1))
+          ways[i] = 0;
+      }
+    }
+  }
+
+  for (u64 i = 0; i < len; ++i) {
+    u64 n = lo + i;
+    if (n == 0) {
+      ways[i] = 1;
+      continue;
+    }
+    u64 rest = n / done[i];
+    if (ways[i] != 0 && rest > 1) {
+      if (rest % 4 == 3) {
+        // however rest factors, some prime = 3 (mod 4) has an odd exponent
+        ways[i] = 0;
+      } else if (rest >= covered) {
+        std::vector<std::pair<u64, int>> factors;
+        factorize_rough(rest, factors);
+        ways[i] *= divisor_product(factors);
+      } else if (rest % 4 == 1) {
+        ways[i] *= 2;
+      }
+    }
+    ways[i] = ways_from_product(ways[i]);
+  }
+}
+
+// sieving primes up to sqrt(2^63) would take gigabytes, beyond this bound the
+// segment falls back to factorize_rough() for the cofactors that need it. That dominates
+// far above 2^48: near 2^62 - 2^64 one core counts roughly 1.2 - 1.6 * 10^5 numbers per
+// second, so a range 10^9 wide there takes about two CPU hours, versus about a minute near
+// 10^12 and six minutes near 2^48
+constexpr uint32_t max_base_prime = 1u << 24;
+
+// Counts for every n in [lo, hi], split in segments and processed by thread_count workers.
+// visit(lo_of_segment, ways_of_segment) is called from the worker threads, once per segment.
+template <typename VISITOR>
+void count_ways_range(u64 lo, u64 hi, VISITOR &&visit, unsigned thread_count = std::thread::hardware_concurrency(),
+                      u64 segment_length = u64(1) << 18) {
+  if (hi < lo)
+    return;
+  const auto base_primes = prime_sieve(static_cast<uint32_t>(std::min<u64>(isqrt(hi), max_base_prime)));
+  const u64 segments = (hi - lo) / segment_length + 1;
+  thread_count = std::max(1u, thread_count);
+  std::atomic<u64> next{0};
+
+  auto worker = [&]() {
+    std::vector<u64> ways;
+    for (u64 s = next++; s < segments; s = next++) {
+      u64 start = lo + s * segment_length;
+      u64 len = std::min(segment_length, hi - start + 1);
+      count_ways_segment(start, len, base_primes, ways);
+      visit(start, ways);
+    }
+  };
+
+  std::vector<std::thread> threads;
+  for (unsigned i = 1; i < thread_count; ++i)
+    threads.emplace_back(worker);
+  worker();
+  for (auto &t : threads)
+    t.join();
+}
+
+} // namespace double_square
@@ -5,6 +5,7 @@
 #include <algorithm>
 #include <cmath> // for sqrt
 #include "linked_list.hpp"
+#include "double_square.hpp"
 
 using namespace std;
 // panel round, based on feedback, function func will be invoked 1B times, but only need to store the last 10 records, so use the circular array approach, less memory, 
@@ -64,21 +65,10 @@ Input
 Create a command line executable called DoubleSquare.exe which takes a single parameter N and
 returns the different ways N can be written as the sum of two squares.
   */
-  int n = 25;
-  auto res = std::vector<std::pair<int, int>>{};
-  int left = 0, right = sqrt(n);
-  while (left <= right) {
-    auto sum = left * left + right * right;
-    if (sum == n) {
-      res.push_back({left, right});
-      ++left;
-      --right;
-    } else if (sum < n) {
-      ++left;
-    } else {
-      --right;
-    }
-  }
+  // factorization based and overflow safe for any 64 bit N, see
+  // double_square.hpp and the DoubleSquare.exe command line in double_square.cpp
+  uint64_t n = 25;
+  auto res = double_square::representations(n);
   if (!res.empty()) {
     for (auto& p : res)
       std::cout << n << " = " << p.first << "^2 + " << p.second << "^2" << std::endl;
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <cstddef>
+#include <iterator>
+#include <memory_resource>
+#include <utility>
+#include "PolygonT.h"
+
+/**
+ * @brief Lazy, pull based alternative to PolygonT::ClipSegments.
+ *
+ * Instead of materialising the whole clipped path, the stream clips one path segment at a
+ * time on demand and yields the clipped segments as pairs, so consumers can start before
+ * the path is processed and only ever hold the output of a single path segment.
+ *
+ * The yielded pairs are exactly (clipped[0], clipped[1]), (clipped[2], clipped[3]), ... of
+ * what ClipSegments would produce for the same input. An unpaired trailing point is dropped.
+ * The polygon and the path must outlive the stream.
+ *
+ * @tparam POINTARRAY The point container of the polygon and the path.
+ */
+template <typename POINTARRAY>
+class ClipStream
+{
+public:
+    using POINTTYPE = typename POINTARRAY::value_type;
+    using SEGMENT = std::pair<POINTTYPE, POINTTYPE>;
+
+    ClipStream(const PolygonT<POINTARRAY> &polygon, const POINTARRAY &tobeclippedpath,
+               std::pmr::memory_resource *resource = std::pmr::get_default_resource())
+        : _polygon(polygon), _path(tobeclippedpath), _intersections(resource), _pending(resource)
+    {
+    }
+
+    // pulls the next clipped segment, returns false once the path is exhausted
+    auto Next(SEGMENT &segment) -> bool
+    {
+        while (_pending.size() - _consumed < 2)
+        {
+            if (_path.size() < 2 || _next + 1 >= _path.size())
+                return false;
+            // keep a possible unpaired point, it pairs with the next output
+            _pending.erase(_pending.begin(), _pending.begin() + _consumed);
+            _consumed = 0;
+            _polygon.ClipPathSegment(_path[_next], _path[_next + 1], _intersections, _pending);
+            ++_next;
+        }
+        segment = {_pending[_consumed], _pending[_consumed + 1]};
+        _consumed += 2;
+        return true;
+    }
+
+    class iterator
+    {
+    public:
+        using iterator_category = std::input_iterator_tag;
+        using value_type = SEGMENT;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const SEGMENT *;
+        using reference = const SEGMENT &;
+
+        iterator() = default;
+        explicit iterator(ClipStream *stream) : _stream(stream) { ++*this; }
+
+        auto operator*() const -> reference { return _segment; }
+        auto operator->() const -> pointer { return &_segment; }
+        auto operator++() -> iterator &
+        {
+            if (_stream && !_stream->Next(_segment))
+                _stream = nullptr;
+            return *this;
+        }
+        auto operator==(const iterator &other) const -> bool { return _stream == other._stream; }
+        auto operator!=(const iterator &other) const -> bool { return _stream != other._stream; }
+
+    private:
+        ClipStream *_stream = nullptr;
+        SEGMENT _segment;
+    };
+
+    // single pass, begin() continues from wherever the stream currently is
+    auto begin() -> iterator { return iterator(this); }
+    auto end() -> iterator { return iterator(); }
+
+private:
+    const PolygonT<POINTARRAY> &_polygon;
+    const POINTARRAY &_path;
+    std::size_t _next = 0;
+    std::pmr::vector<POINTTYPE> _intersections;
+    std::pmr::vector<POINTTYPE> _pending;
+    std::size_t _consumed = 0;
+};
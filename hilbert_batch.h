@@ -0,0 +1,149 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "PolygonT.h"
+
+// bits per axis of the Hilbert curve, keys fit in 32 bits
+constexpr int HILBERT_ORDER = 16;
+
+/**
+ * @brief Distance of the cell (x, y) along a Hilbert curve of HILBERT_ORDER.
+ *
+ * Cells close along the curve are close in the plane, so sorting queries by this key
+ * makes consecutive queries touch the same part of any spatial index.
+ */
+constexpr auto HilbertKey(uint32_t x, uint32_t y) -> uint32_t
+{
+    uint32_t key = 0;
+    for (uint32_t s = 1u << (HILBERT_ORDER - 1); s > 0; s >>= 1)
+    {
+        uint32_t rx = (x & s) ? 1 : 0;
+        uint32_t ry = (y & s) ? 1 : 0;
+        key += s * s * ((3 * rx) ^ ry);
+        // rotate the quadrant so the curve stays continuous
+        if (ry == 0)
+        {
+            if (rx == 1)
+            {
+                x = s - 1 - x;
+                y = s - 1 - y;
+            }
+            std::swap(x, y);
+        }
+    }
+    return key;
+}
+
+/**
+ * @brief The permutation that visits the points in Hilbert curve order.
+ *
+ * The points are scaled to the 2^HILBERT_ORDER grid over their own bbox, the keys are then
+ * LSD radix sorted a byte at a time, skipping bytes all keys share.
+ *
+ * @return order, with points[order[0]], points[order[1]], ... in curve order.
+ */
+template <typename POINTARRAY>
+auto HilbertOrder(const POINTARRAY &points) -> std::vector<uint32_t>
+{
+    const auto n = points.size();
+    std::vector<uint32_t> order(n);
+    if (n == 0)
+        return order;
+    double min_x = fix_x(points[0]), max_x = min_x, min_y = fix_y(points[0]), max_y = min_y;
+    for (std::size_t i = 0; i < n; ++i)
+    {
+        min_x = std::min<double>(min_x, fix_x(points[i]));
+        max_x = std::max<double>(max_x, fix_x(points[i]));
+        min_y = std::min<double>(min_y, fix_y(points[i]));
+        max_y = std::max<double>(max_y, fix_y(points[i]));
+    }
+    const double cells = (1u << HILBERT_ORDER) - 1;
+    const double scale_x = max_x > min_x ? cells / (max_x - min_x) : 0;
+    const double scale_y = max_y > min_y ? cells / (max_y - min_y) : 0;
+
+    std::vector<std::pair<uint32_t, uint32_t>> keyed(n), buffer(n);
+    uint32_t all_and = ~0u, all_or = 0;
+    for (std::size_t i = 0; i < n; ++i)
+    {
+        auto x = static_cast<uint32_t>((fix_x(points[i]) - min_x) * scale_x);
+        auto y = static_cast<uint32_t>((fix_y(points[i]) - min_y) * scale_y);
+        keyed[i] = {HilbertKey(x, y), static_cast<uint32_t>(i)};
+        all_and &= keyed[i].first;
+        all_or |= keyed[i].first;
+    }
+
+    for (int shift = 0; shift < 32; shift += 8)
+    {
+        if ((((all_and ^ all_or) >> shift) & 0xff) == 0)
+            continue;
+        std::array<std::size_t, 257> counts{};
+        for (const auto &entry : keyed)
+            ++counts[((entry.first >> shift) & 0xff) + 1];
+        for (std::size_t b = 0; b < 256; ++b)
+            counts[b + 1] += counts[b];
+        for (const auto &entry : keyed)
+            buffer[counts[(entry.first >> shift) & 0xff]++] = entry;
+        keyed.swap(buffer);
+    }
+    for (std::size_t i = 0; i < n; ++i)
+        order[i] = keyed[i].second;
+    return order;
+}
+
+// Type trait to check if a classifier takes a QueryHint carried between queries
+template <typename CLASSIFIER, typename POINTTYPE, typename = std::void_t<>>
+struct has_query_hint : std::false_type
+{
+};
+
+template <typename CLASSIFIER, typename POINTTYPE>
+struct has_query_hint<CLASSIFIER, POINTTYPE,
+                      std::void_t<decltype(std::declval<const CLASSIFIER &>().Classify(
+                          std::declval<const POINTTYPE &>(), std::declval<typename CLASSIFIER::QueryHint &>()))>>
+    : std::true_type
+{
+};
+
+/**
+ * @brief Classifies a batch of points in Hilbert curve order.
+ *
+ * The queries run in spatial order, so consecutive queries touch the same part of the
+ * classifier's index, carrying the classifier's QueryHint from one query to the next when it
+ * has one (e.g. SlabPolygonT). The results are scattered back so that result[i] belongs to
+ * points[i].
+ *
+ * @tparam CLASSIFIER Any type with Classify(point) -> PolygonTestResult, e.g. PolygonT,
+ *         SlabPolygonT or PolygonBVHT.
+ * @param order A HilbertOrder of points, reusable when classifying against several polygons.
+ */
+template <typename CLASSIFIER, typename POINTARRAY>
+auto BatchClassify(const CLASSIFIER &classifier, const POINTARRAY &points, const std::vector<uint32_t> &order)
+    -> std::vector<PolygonTestResult>
+{
+    using POINTTYPE = typename POINTARRAY::value_type;
+    std::vector<PolygonTestResult> results(points.size(), PolygonTestResult::UNKNOWN);
+    if constexpr (has_query_hint<CLASSIFIER, POINTTYPE>::value)
+    {
+        typename CLASSIFIER::QueryHint hint{};
+        for (auto i : order)
+            results[i] = classifier.Classify(points[i], hint);
+    }
+    else
+    {
+        for (auto i : order)
+            results[i] = classifier.Classify(points[i]);
+    }
+    return results;
+}
+
+template <typename CLASSIFIER, typename POINTARRAY>
+auto BatchClassify(const CLASSIFIER &classifier, const POINTARRAY &points) -> std::vector<PolygonTestResult>
+{
+    return BatchClassify(classifier, points, HilbertOrder(points));
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <stdexcept>
+
+/**
+ * @brief A vector like container with a fixed capacity stored inline.
+ *
+ * Used for results whose size has a small upper bound known at compile time, e.g. the
+ * intersection points of two line segments, so producing them never touches the heap.
+ *
+ * @tparam T The element type.
+ * @tparam N The capacity.
+ */
+template <typename T, std::size_t N>
+class InlineVector
+{
+public:
+    using value_type = T;
+    using size_type = std::size_t;
+    using iterator = typename std::array<T, N>::iterator;
+    using const_iterator = typename std::array<T, N>::const_iterator;
+
+    auto push_back(const T &value) -> void
+    {
+        if (_size == N)
+            throw std::length_error("InlineVector capacity exceeded");
+        _items[_size++] = value;
+    }
+
+    // keeps the elements sorted and unique, like inserting into a std::set
+    auto insert_unique(const T &value) -> void
+    {
+        auto it = std::lower_bound(begin(), end(), value);
+        if (it != end() && !(value < *it))
+            return;
+        push_back(value);
+        std::rotate(it, end() - 1, end());
+    }
+
+    auto clear() -> void { _size = 0; }
+    auto size() const -> size_type { return _size; }
+    auto empty() const -> bool { return _size == 0; }
+    static constexpr auto capacity() -> size_type { return N; }
+
+    auto operator[](size_type i) -> T & { return _items[i]; }
+    auto operator[](size_type i) const -> const T & { return _items[i]; }
+
+    auto begin() -> iterator { return _items.begin(); }
+    auto end() -> iterator { return _items.begin() + _size; }
+    auto begin() const -> const_iterator { return _items.begin(); }
+    auto end() const -> const_iterator { return _items.begin() + _size; }
+
+private:
+    std::array<T, N> _items{};
+    size_type _size = 0;
+};
@@ -0,0 +1,368 @@
+#pragma once
+
+// Optional hot path instrumentation for PolygonT.
+//
+// Compile with -DPOLYGON_INSTRUMENTATION to enable it, otherwise the POLYGON_COUNT and
+// POLYGON_TIMED_SCOPE macros expand to nothing and PolygonT carries no overhead at all.
+//
+// Every thread owns its own counters and latency histograms, written without any lock
+// or read-modify-write atomics. PolygonInstrumentation::Snapshot() sums the per thread
+// data of all running threads and the totals of the finished ones, whose data is merged
+// into the totals and released when they exit. Export() dumps it as text.
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <memory_resource>
+#include <mutex>
+#include <vector>
+
+#define POLYGONHOTPATHS(code) \
+    code(InPolygonTest) code(ClipSegments) code(SegmentIntersection)
+
+enum class PolygonHotPath
+{
+#define ENUM_ITEM(x) x,
+    POLYGONHOTPATHS(ENUM_ITEM)
+#undef ENUM_ITEM
+        PATHCOUNT
+};
+
+#define POLYGONCOUNTERS(code)                                                                          \
+    code(InPolygonQueries) code(EdgesVisited) code(SegmentIntersections) code(ParallelSegmentIntersections) \
+        code(ClippedPathSegments) code(ClipAllocations) code(ClippedPointsPushed) code(LevelOfDetailFallbacks)
+
+enum class PolygonCounter
+{
+#define ENUM_ITEM(x) x,
+    POLYGONCOUNTERS(ENUM_ITEM)
+#undef ENUM_ITEM
+        COUNTERCOUNT
+};
+
+const std::array<const char *, static_cast<int>(PolygonHotPath::PATHCOUNT)> _hotPathStrings = {{
+#define ITEM_STRING(x) #x,
+    POLYGONHOTPATHS(ITEM_STRING)
+#undef ITEM_STRING
+}};
+
+const std::array<const char *, static_cast<int>(PolygonCounter::COUNTERCOUNT)> _counterStrings = {{
+#define ITEM_STRING(x) #x,
+    POLYGONCOUNTERS(ITEM_STRING)
+#undef ITEM_STRING
+}};
+
+/**
+ * @brief HDR style log-linear latency histogram in nanoseconds.
+ *
+ * Values below 2^SUBBITS get an exact bucket, above that every power of two range is split
+ * into 2^SUBBITS linear sub buckets, so the relative error of any recorded value is below
+ * 1 / 2^SUBBITS (about 3%). Values above 2^MAXBITS ns (about 18 minutes) are clamped.
+ */
+class LatencyHistogram
+{
+public:
+    static constexpr int SUBBITS = 5;
+    static constexpr int MAXBITS = 40;
+    static constexpr int SUBCOUNT = 1 << SUBBITS;
+    static constexpr int BUCKETCOUNT = (MAXBITS - SUBBITS + 1) * SUBCOUNT;
+
+    static constexpr auto BucketIndex(uint64_t value) -> int
+    {
+        if (value >= (uint64_t(1) << MAXBITS))
+            value = (uint64_t(1) << MAXBITS) - 1;
+        if (value < SUBCOUNT)
+            return static_cast<int>(value);
+        int msb = 63;
+        while (!(value >> msb))
+            --msb;
+        int shift = msb - SUBBITS;
+        return (shift + 1) * SUBCOUNT + static_cast<int>((value >> shift) & (SUBCOUNT - 1));
+    }
+
+    // the smallest value that lands in the bucket
+    static constexpr auto BucketLowerBound(int index) -> uint64_t
+    {
+        if (index < SUBCOUNT)
+            return static_cast<uint64_t>(index);
+        int shift = index / SUBCOUNT - 1;
+        return (static_cast<uint64_t>(SUBCOUNT + index % SUBCOUNT)) << shift;
+    }
+
+    // single writer: only the owning thread records, readers may load concurrently
+    auto Record(uint64_t value) -> void
+    {
+        Bump(_buckets[BucketIndex(value)], 1);
+        Bump(_count, 1);
+        Bump(_sum, value);
+        if (value > _max.load(std::memory_order_relaxed))
+            _max.store(value, std::memory_order_relaxed);
+    }
+
+    auto Reset() -> void
+    {
+        for (auto &bucket : _buckets)
+            bucket.store(0, std::memory_order_relaxed);
+        _count.store(0, std::memory_order_relaxed);
+        _sum.store(0, std::memory_order_relaxed);
+        _max.store(0, std::memory_order_relaxed);
+    }
+
+    static auto Bump(std::atomic<uint64_t> &value, uint64_t n) -> void
+    {
+        value.store(value.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+    }
+
+private:
+    friend struct LatencySnapshot;
+    std::array<std::atomic<uint64_t>, BUCKETCOUNT> _buckets{};
+    std::atomic<uint64_t> _count{0}, _sum{0}, _max{0};
+};
+
+// merged, immutable copy of one or more LatencyHistogram
+struct LatencySnapshot
+{
+    uint64_t count = 0, sum = 0, max = 0;
+    std::vector<uint64_t> buckets = std::vector<uint64_t>(LatencyHistogram::BUCKETCOUNT, 0);
+
+    auto Merge(const LatencyHistogram &histogram) -> void
+    {
+        for (auto i = 0; i < LatencyHistogram::BUCKETCOUNT; ++i)
+            buckets[i] += histogram._buckets[i].load(std::memory_order_relaxed);
+        count += histogram._count.load(std::memory_order_relaxed);
+        sum += histogram._sum.load(std::memory_order_relaxed);
+        max = std::max(max, histogram._max.load(std::memory_order_relaxed));
+    }
+
+    auto Mean() const -> double { return count ? static_cast<double>(sum) / count : 0.0; }
+
+    // value at quantile q in [0, 1], reported as the lower bound of its bucket
+    auto Percentile(double q) const -> uint64_t
+    {
+        if (count == 0)
+            return 0;
+        auto rank = static_cast<uint64_t>(q * (count - 1)) + 1;
+        uint64_t seen = 0;
+        for (auto i = 0; i < LatencyHistogram::BUCKETCOUNT; ++i)
+        {
+            seen += buckets[i];
+            if (seen >= rank)
+                return std::min(LatencyHistogram::BucketLowerBound(i), max);
+        }
+        return max;
+    }
+};
+
+// everything one thread records
+struct PolygonThreadStats
+{
+    std::array<std::atomic<uint64_t>, static_cast<int>(PolygonCounter::COUNTERCOUNT)> counters{};
+    std::array<LatencyHistogram, static_cast<int>(PolygonHotPath::PATHCOUNT)> histograms;
+};
+
+struct PolygonStatsSnapshot
+{
+    std::array<uint64_t, static_cast<int>(PolygonCounter::COUNTERCOUNT)> counters{};
+    std::array<LatencySnapshot, static_cast<int>(PolygonHotPath::PATHCOUNT)> latencies;
+
+    auto Counter(PolygonCounter counter) const -> uint64_t { return counters[static_cast<int>(counter)]; }
+    auto Latency(PolygonHotPath path) const -> const LatencySnapshot & { return latencies[static_cast<int>(path)]; }
+};
+
+class PolygonInstrumentation
+{
+public:
+    // called once the duration of a hot path exceeds the threshold, with the polygon that
+    // ran the query (nullptr for the free functions) and the edges it visited
+    using SlowQueryHook = std::function<void(const void *polygon, PolygonHotPath path, uint64_t nanoseconds, uint64_t edges)>;
+
+    static auto Local() -> PolygonThreadStats &
+    {
+        thread_local ThreadEntry entry;
+        return entry.stats;
+    }
+
+    static auto Add(PolygonCounter counter, uint64_t n) -> void
+    {
+        LatencyHistogram::Bump(Local().counters[static_cast<int>(counter)], n);
+    }
+
+    static auto Snapshot() -> PolygonStatsSnapshot
+    {
+        std::lock_guard<std::mutex> lock(Registry().mutex);
+        auto snapshot = Registry().retired;
+        for (auto *stats : Registry().threads)
+            Merge(snapshot, *stats);
+        return snapshot;
+    }
+
+    // not synchronised with running queries, values recorded meanwhile may survive
+    static auto Reset() -> void
+    {
+        std::lock_guard<std::mutex> lock(Registry().mutex);
+        Registry().retired = {};
+        for (auto *stats : Registry().threads)
+        {
+            for (auto &counter : stats->counters)
+                counter.store(0, std::memory_order_relaxed);
+            for (auto &histogram : stats->histograms)
+                histogram.Reset();
+        }
+    }
+
+    static auto Export(std::ostream &stream, const PolygonStatsSnapshot &snapshot = Snapshot()) -> void
+    {
+        for (auto i = 0; i < static_cast<int>(PolygonCounter::COUNTERCOUNT); ++i)
+            stream << _counterStrings[i] << ": " << snapshot.counters[i] << std::endl;
+        for (auto i = 0; i < static_cast<int>(PolygonHotPath::PATHCOUNT); ++i)
+        {
+            const auto &latency = snapshot.latencies[i];
+            stream << _hotPathStrings[i] << " ns: count=" << latency.count << " mean=" << latency.Mean()
+                   << " p50=" << latency.Percentile(0.5) << " p90=" << latency.Percentile(0.9)
+                   << " p99=" << latency.Percentile(0.99) << " p999=" << latency.Percentile(0.999)
+                   << " max=" << latency.max << std::endl;
+        }
+    }
+
+    static auto SetSlowQueryHook(uint64_t threshold_ns, SlowQueryHook hook) -> void
+    {
+        std::lock_guard<std::mutex> lock(Registry().mutex);
+        Registry().slow_hook = std::make_shared<const SlowQueryHook>(std::move(hook));
+        Registry().slow_threshold.store(threshold_ns, std::memory_order_relaxed);
+    }
+
+    static auto SlowThreshold() -> uint64_t { return Registry().slow_threshold.load(std::memory_order_relaxed); }
+
+    static auto ReportSlowQuery(const void *polygon, PolygonHotPath path, uint64_t nanoseconds, uint64_t edges) -> void
+    {
+        std::shared_ptr<const SlowQueryHook> hook;
+        {
+            std::lock_guard<std::mutex> lock(Registry().mutex);
+            hook = Registry().slow_hook;
+        }
+        if (hook && *hook)
+            (*hook)(polygon, path, nanoseconds, edges);
+    }
+
+private:
+    struct RegistryData
+    {
+        std::mutex mutex;
+        std::vector<PolygonThreadStats *> threads;
+        // everything recorded by threads that have exited
+        PolygonStatsSnapshot retired;
+        std::shared_ptr<const SlowQueryHook> slow_hook;
+        std::atomic<uint64_t> slow_threshold{UINT64_MAX};
+    };
+
+    static auto Registry() -> RegistryData &
+    {
+        static RegistryData registry;
+        return registry;
+    }
+
+    static auto Merge(PolygonStatsSnapshot &snapshot, const PolygonThreadStats &stats) -> void
+    {
+        for (auto i = 0; i < static_cast<int>(PolygonCounter::COUNTERCOUNT); ++i)
+            snapshot.counters[i] += stats.counters[i].load(std::memory_order_relaxed);
+        for (auto i = 0; i < static_cast<int>(PolygonHotPath::PATHCOUNT); ++i)
+            snapshot.latencies[i].Merge(stats.histograms[i]);
+    }
+
+    // registered for the lifetime of its thread, folded into the retired totals on exit,
+    // so short lived worker threads do not grow the registry
+    struct ThreadEntry
+    {
+        PolygonThreadStats stats;
+
+        ThreadEntry()
+        {
+            std::lock_guard<std::mutex> lock(Registry().mutex);
+            Registry().threads.push_back(&stats);
+        }
+        ThreadEntry(const ThreadEntry &) = delete;
+        ThreadEntry &operator=(const ThreadEntry &) = delete;
+        ~ThreadEntry()
+        {
+            std::lock_guard<std::mutex> lock(Registry().mutex);
+            auto &threads = Registry().threads;
+            threads.erase(std::find(threads.begin(), threads.end(), &stats));
+            Merge(Registry().retired, stats);
+        }
+    };
+};
+
+// records the duration of a scope into the thread local histogram of the hot path
+class PolygonScopedTimer
+{
+public:
+    PolygonScopedTimer(PolygonHotPath path, const void *polygon)
+        : _path(path), _polygon(polygon), _stats(PolygonInstrumentation::Local()),
+          _edges(_stats.counters[static_cast<int>(PolygonCounter::EdgesVisited)].load(std::memory_order_relaxed)),
+          _start(std::chrono::steady_clock::now())
+    {
+    }
+    PolygonScopedTimer(const PolygonScopedTimer &) = delete;
+    PolygonScopedTimer &operator=(const PolygonScopedTimer &) = delete;
+    ~PolygonScopedTimer()
+    {
+        auto ns = static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - _start).count());
+        _stats.histograms[static_cast<int>(_path)].Record(ns);
+        if (ns >= PolygonInstrumentation::SlowThreshold())
+        {
+            auto edges = _stats.counters[static_cast<int>(PolygonCounter::EdgesVisited)].load(std::memory_order_relaxed) - _edges;
+            PolygonInstrumentation::ReportSlowQuery(_polygon, _path, ns, edges);
+        }
+    }
+
+private:
+    PolygonHotPath _path;
+    const void *_polygon;
+    PolygonThreadStats &_stats;
+    uint64_t _edges;
+    std::chrono::steady_clock::time_point _start;
+};
+
+#define POLYGON_CONCAT_IMPL(a, b) a##b
+#define POLYGON_CONCAT(a, b) POLYGON_CONCAT_IMPL(a, b)
+
+#ifdef POLYGON_INSTRUMENTATION
+#define POLYGON_COUNT(counter, n) PolygonInstrumentation::Add(PolygonCounter::counter, (n))
+#define POLYGON_TIMED_SCOPE(path, polygon) \
+    PolygonScopedTimer POLYGON_CONCAT(_polygonTimer, __LINE__)(PolygonHotPath::path, (polygon))
+#else
+#define POLYGON_COUNT(counter, n) ((void)0)
+#define POLYGON_TIMED_SCOPE(path, polygon) ((void)0)
+#endif
+
+// forwards to upstream and adds every allocation to a counter, e.g. to count the real
+// allocations of a pmr container instead of guessing them from its pushes
+class PolygonCountingResource : public std::pmr::memory_resource
+{
+public:
+    PolygonCountingResource(std::pmr::memory_resource *upstream, PolygonCounter counter)
+        : _upstream(upstream), _counter(counter)
+    {
+    }
+
+private:
+    auto do_allocate(std::size_t bytes, std::size_t alignment) -> void * override
+    {
+        PolygonInstrumentation::Add(_counter, 1);
+        return _upstream->allocate(bytes, alignment);
+    }
+    auto do_deallocate(void *pointer, std::size_t bytes, std::size_t alignment) -> void override
+    {
+        _upstream->deallocate(pointer, bytes, alignment);
+    }
+    auto do_is_equal(const std::pmr::memory_resource &other) const noexcept -> bool override { return this == &other; }
+
+    std::pmr::memory_resource *_upstream;
+    PolygonCounter _counter;
+};
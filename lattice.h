@@ -0,0 +1,134 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <vector>
+#include "PolygonT.h"
+
+/**
+ * @brief A regular grid of query points, e.g. raster cell centres.
+ *
+ * The point of column c and row r is (origin_x + c * step_x, origin_y + r * step_y).
+ */
+struct LatticeSpec
+{
+    double origin_x = 0, origin_y = 0;
+    double step_x = 1, step_y = 1;
+    std::size_t columns = 0, rows = 0;
+
+    auto X(std::size_t column) const -> double { return origin_x + column * step_x; }
+    auto Y(std::size_t row) const -> double { return origin_y + row * step_y; }
+};
+
+/**
+ * @brief Classifies every point of a lattice against a polygon, one scanline at a time.
+ *
+ * For each row the crossings of the row with the edges are computed once and sorted, then
+ * the row is filled as runs between consecutive crossings, which costs O(rows * edges + cells)
+ * instead of O(cells * edges). Cells within EPSILON of an edge become OnPolygonEdge. The
+ * result is the same as classifying every point with CrossingNumberStep.
+ *
+ * @tparam POINTARRAY The point container of the polygon.
+ * @tparam VISITOR Called as visitor(row, const PolygonTestResult *cells) once per row, the
+ *         cells are only valid during the call.
+ * @param points The polygon.
+ * @param lattice The grid, step_x must be positive.
+ */
+template <typename POINTARRAY, typename VISITOR>
+auto ClassifyLatticeRows(const POINTARRAY &points, const LatticeSpec &lattice, VISITOR &&visitor) -> void
+{
+    static_assert(has_indexer_v<POINTARRAY>,
+                  "Template argument must have an indexer");
+    const auto n = points.size();
+    std::vector<PolygonTestResult> cells(lattice.columns);
+    if (n < 3)
+    {
+        std::fill(cells.begin(), cells.end(), PolygonTestResult::UNKNOWN);
+        for (std::size_t row = 0; row < lattice.rows; ++row)
+            visitor(row, cells.data());
+        return;
+    }
+
+    std::vector<std::array<double, 4>> edges(n);
+    for (std::size_t i = 0; i < n; ++i)
+        edges[i] = {static_cast<double>(fix_x(points[i])), static_cast<double>(fix_y(points[i])),
+                    static_cast<double>(fix_x(points[(i + 1) % n])), static_cast<double>(fix_y(points[(i + 1) % n]))};
+
+    // first column whose x is not below value, using the same arithmetic as lattice.X
+    auto first_column_from = [&lattice](double value, std::size_t low) -> std::size_t
+    {
+        auto guess = std::ceil((value - lattice.origin_x) / lattice.step_x);
+        auto column = guess <= static_cast<double>(low) ? low
+                      : guess >= static_cast<double>(lattice.columns) ? lattice.columns
+                                                                      : static_cast<std::size_t>(guess);
+        while (column > low && lattice.X(column - 1) >= value)
+            --column;
+        while (column < lattice.columns && lattice.X(column) < value)
+            ++column;
+        return column;
+    };
+
+    std::vector<double> crossings;
+    for (std::size_t row = 0; row < lattice.rows; ++row)
+    {
+        const auto y = lattice.Y(row);
+        crossings.clear();
+        for (const auto &[start_x, start_y, end_x, end_y] : edges)
+        {
+            // same half open rule and formula as CrossingNumberStep
+            if ((start_y > y) != (end_y > y))
+                crossings.push_back(start_x + (y - start_y) * (end_x - start_x) / (end_y - start_y));
+        }
+        std::sort(crossings.begin(), crossings.end());
+
+        // a cell is inside when an odd number of crossings lie strictly right of it, as the
+        // crossing count is even that is when an odd number lie at or left of it
+        std::size_t column = 0;
+        for (std::size_t k = 0; k <= crossings.size(); ++k)
+        {
+            auto end = k < crossings.size() ? first_column_from(crossings[k], column)
+                                            : lattice.columns;
+            auto status = k % 2 ? PolygonTestResult::InPolygon : PolygonTestResult::OutsidePolygon;
+            std::fill(cells.begin() + column, cells.begin() + end, status);
+            column = end;
+        }
+
+        // edges passing within EPSILON of the row, only their x extent needs the exact test
+        for (const auto &[start_x, start_y, end_x, end_y] : edges)
+        {
+            if (y < std::min(start_y, end_y) - EPSILON || y > std::max(start_y, end_y) + EPSILON)
+                continue;
+            auto low_x = std::min(start_x, end_x), high_x = std::max(start_x, end_x);
+            if (start_y != end_y)
+            {
+                // the part of the edge inside the band |y' - y| <= EPSILON
+                auto t0 = (y - EPSILON - start_y) / (end_y - start_y), t1 = (y + EPSILON - start_y) / (end_y - start_y);
+                auto t_low = std::max(0.0, std::min(t0, t1)), t_high = std::min(1.0, std::max(t0, t1));
+                auto x0 = start_x + t_low * (end_x - start_x), x1 = start_x + t_high * (end_x - start_x);
+                low_x = std::min(x0, x1);
+                high_x = std::max(x0, x1);
+            }
+            auto first = first_column_from(low_x - 2 * EPSILON, 0);
+            for (auto c = first; c < lattice.columns && lattice.X(c) <= high_x + 2 * EPSILON; ++c)
+            {
+                bool on_edge = false, inside = false;
+                CrossingNumberStep(start_x, start_y, end_x, end_y, lattice.X(c), y, on_edge, inside);
+                if (on_edge)
+                    cells[c] = PolygonTestResult::OnPolygonEdge;
+            }
+        }
+        visitor(row, cells.data());
+    }
+}
+
+// the whole lattice, row major
+template <typename POINTARRAY>
+auto ClassifyLattice(const POINTARRAY &points, const LatticeSpec &lattice) -> std::vector<PolygonTestResult>
+{
+    std::vector<PolygonTestResult> result(lattice.columns * lattice.rows);
+    ClassifyLatticeRows(points, lattice, [&](std::size_t row, const PolygonTestResult *cells)
+                        { std::copy(cells, cells + lattice.columns, result.begin() + row * lattice.columns); });
+    return result;
+}
@@ -1,42 +1,37 @@
 #pragma once
 
+#include <array>
+#include <cstddef>
+#include <functional>
 #include <iostream>
 
 template <typename COORDTYPE>
 class Point2DT
 {
 public:
+     // trivially copyable and without a virtual destructor, so points are literal
+     // types and can be used in constant expressions, see FixedPolygonT
      Point2DT() = default;
-     Point2DT(COORDTYPE x, COORDTYPE y) : _point{x, y} {}
-     Point2DT(const Point2DT &pt)
-     {
-          std::memcpy(_point.data(), pt._point.data(), 2 * sizeof(COORDTYPE));
-     }
-     Point2DT &operator=(const Point2DT &pt)
-     {
-          if (this != &pt)
-          {
-               std::memcpy(_point.data(), pt._point.data(), 2 * sizeof(COORDTYPE));
-          }
-          return *this;
-     }
+     constexpr Point2DT(COORDTYPE x, COORDTYPE y) : _point{x, y} {}
+     Point2DT(const Point2DT &pt) = default;
+     Point2DT &operator=(const Point2DT &pt) = default;
 
-     bool operator==(const Point2DT &other) const
+     constexpr bool operator==(const Point2DT &other) const
      {
           return _point[0] == other.X() && _point[1] == other.Y();
      }
-     bool operator<(const Point2DT &other) const
+     constexpr bool operator<(const Point2DT &other) const
      {
           return _point[0] < other.X() || _point[0] == other.X() && _point[1] < other.Y();
      }
-     virtual ~Point2DT() = default;
+     ~Point2DT() = default;
      friend std::ostream &operator<<(std::ostream &stream, const Point2DT &obj)
      {
           stream << obj.X() << "," << obj.Y();
           return stream;
      }
-     auto X() const -> COORDTYPE { return _point[0]; }
-     auto Y() const -> COORDTYPE { return _point[1]; }
+     constexpr auto X() const -> COORDTYPE { return _point[0]; }
+     constexpr auto Y() const -> COORDTYPE { return _point[1]; }
 
 private:
      std::array<COORDTYPE, 2> _point;
@@ -47,31 +42,18 @@ class PointXYT
 {
 public:
      PointXYT() = default;
-     PointXYT(COORDTYPE ptx, COORDTYPE pty) : x{ptx}, y{pty} {}
-     PointXYT(const PointXYT<COORDTYPE> &pt)
-     {
-          x = pt.x;
-          y = pt.y;
-
-     }
-     PointXYT &operator=(const PointXYT &pt)
-     {
-          if (this != &pt)
-          {
-               x = pt.x;
-               y = pt.y;
-          }
-          return *this;
-     }
-     bool operator==(const PointXYT &other) const
+     constexpr PointXYT(COORDTYPE ptx, COORDTYPE pty) : x{ptx}, y{pty} {}
+     PointXYT(const PointXYT<COORDTYPE> &pt) = default;
+     PointXYT &operator=(const PointXYT &pt) = default;
+     constexpr bool operator==(const PointXYT &other) const
      {
           return x == other.x && y == other.y;
      }
-     bool operator<(const PointXYT &other) const
+     constexpr bool operator<(const PointXYT &other) const
      {
           return x < other.x || x == other.x && y < other.y;
      }
-     virtual ~PointXYT() = default;
+     ~PointXYT() = default;
      friend std::ostream &operator<<(std::ostream &stream, const PointXYT &obj)
      {
           stream << obj.x << "," << obj.y;
@@ -80,3 +62,27 @@ public:
 
      COORDTYPE x, y;
 };
+
+// hashes consistent with operator==, for hash containers and QueryCacheT
+namespace std
+{
+template <typename COORDTYPE>
+struct hash<Point2DT<COORDTYPE>>
+{
+     auto operator()(const Point2DT<COORDTYPE> &point) const noexcept -> std::size_t
+     {
+          auto seed = std::hash<COORDTYPE>{}(point.X());
+          return seed ^ (std::hash<COORDTYPE>{}(point.Y()) + 0x9e3779b97f4a7c15ull + (seed << 6) + (seed >> 2));
+     }
+};
+
+template <typename COORDTYPE>
+struct hash<PointXYT<COORDTYPE>>
+{
+     auto operator()(const PointXYT<COORDTYPE> &point) const noexcept -> std::size_t
+     {
+          auto seed = std::hash<COORDTYPE>{}(point.x);
+          return seed ^ (std::hash<COORDTYPE>{}(point.y) + 0x9e3779b97f4a7c15ull + (seed << 6) + (seed >> 2));
+     }
+};
+} // namespace std
@@ -0,0 +1,278 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "PolygonT.h"
+
+/**
+ * @brief Bounded, thread safe memo of point query results.
+ *
+ * Entries are keyed on the exact point (its operator== and std::hash) and a caller chosen
+ * polygon version, e.g. a polygon id combined with a generation bumped on every edit, so
+ * results of an older geometry are never returned and simply age out.
+ *
+ * The cache is split into independently locked shards picked by the key hash, so parallel
+ * batches rarely contend. Each shard holds a fixed number of slots evicted with the CLOCK
+ * policy: a hit sets the slot's reference bit, the hand clears set bits and evicts the
+ * first slot found without one, approximating LRU without reordering anything on a hit.
+ *
+ * @tparam POINTTYPE The type representing a point.
+ * @tparam VALUE The memoized result, PolygonTestResult for the Classify front ends or
+ *         std::string for PolygonT::InPolygonTest.
+ */
+template <typename POINTTYPE, typename VALUE = PolygonTestResult>
+class QueryCacheT
+{
+public:
+    struct Stats
+    {
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        uint64_t evictions = 0;
+        std::size_t size = 0;
+    };
+
+    explicit QueryCacheT(std::size_t capacity, std::size_t shards = 16)
+    {
+        _shard_count = 1;
+        while (_shard_count < shards)
+            _shard_count <<= 1;
+        _shards = std::make_unique<Shard[]>(_shard_count);
+        const auto per_shard = std::max<std::size_t>(1, (capacity + _shard_count - 1) / _shard_count);
+        for (std::size_t s = 0; s < _shard_count; ++s)
+        {
+            auto &shard = _shards[s];
+            shard.capacity = per_shard;
+            shard.slots.reserve(per_shard);
+            // at most half full, so probe sequences stay short
+            std::size_t table_size = 2;
+            while (table_size < 2 * per_shard)
+                table_size <<= 1;
+            shard.table.assign(table_size, EMPTY);
+        }
+    }
+
+    QueryCacheT(const QueryCacheT &) = delete;
+    QueryCacheT &operator=(const QueryCacheT &) = delete;
+
+    // true and the cached value if present
+    auto Find(const POINTTYPE &point, uint64_t version, VALUE &value) -> bool
+    {
+        const Key key{point, version};
+        const auto hash = Hash(key);
+        auto &shard = ShardOf(hash);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        auto position = shard.Locate(key, hash);
+        if (shard.table[position] == EMPTY)
+        {
+            ++shard.misses;
+            return false;
+        }
+        ++shard.hits;
+        auto &slot = shard.slots[shard.table[position]];
+        slot.referenced = true;
+        value = slot.value;
+        return true;
+    }
+
+    auto Insert(const POINTTYPE &point, uint64_t version, const VALUE &value) -> void
+    {
+        const Key key{point, version};
+        const auto hash = Hash(key);
+        auto &shard = ShardOf(hash);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        auto position = shard.Locate(key, hash);
+        if (shard.table[position] != EMPTY)
+        {
+            // another thread computed the same key meanwhile
+            shard.slots[shard.table[position]].value = value;
+            return;
+        }
+        if (shard.slots.size() < shard.capacity)
+        {
+            shard.table[position] = static_cast<uint32_t>(shard.slots.size());
+            shard.slots.push_back({key, value, hash, false});
+            return;
+        }
+        while (shard.slots[shard.hand].referenced)
+        {
+            shard.slots[shard.hand].referenced = false;
+            shard.hand = shard.hand + 1 == shard.slots.size() ? 0 : shard.hand + 1;
+        }
+        auto &victim = shard.slots[shard.hand];
+        shard.Erase(shard.Locate(victim.key, victim.hash));
+        ++shard.evictions;
+        victim = {key, value, hash, false};
+        // the erase may have moved entries, the free position is looked up again
+        shard.table[shard.Locate(key, hash)] = static_cast<uint32_t>(shard.hand);
+        shard.hand = shard.hand + 1 == shard.slots.size() ? 0 : shard.hand + 1;
+    }
+
+    /**
+     * @brief The cached value, or compute() stored and returned on a miss.
+     *
+     * compute runs without any lock held, so concurrent misses of the same key may both
+     * compute it, the results are equal and the second insert just overwrites the first.
+     */
+    template <typename COMPUTE>
+    auto GetOrCompute(const POINTTYPE &point, uint64_t version, COMPUTE &&compute) -> VALUE
+    {
+        VALUE value;
+        if (Find(point, version, value))
+            return value;
+        value = compute();
+        Insert(point, version, value);
+        return value;
+    }
+
+    auto Clear() -> void
+    {
+        for (std::size_t s = 0; s < _shard_count; ++s)
+        {
+            auto &shard = _shards[s];
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            shard.slots.clear();
+            std::fill(shard.table.begin(), shard.table.end(), EMPTY);
+            shard.hand = 0;
+        }
+    }
+
+    // counters summed over all shards, consistent per shard only
+    auto GetStats() const -> Stats
+    {
+        Stats stats;
+        for (std::size_t s = 0; s < _shard_count; ++s)
+        {
+            auto &shard = _shards[s];
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            stats.hits += shard.hits;
+            stats.misses += shard.misses;
+            stats.evictions += shard.evictions;
+            stats.size += shard.slots.size();
+        }
+        return stats;
+    }
+
+    auto Capacity() const -> std::size_t { return _shard_count * _shards[0].capacity; }
+    auto ShardCount() const -> std::size_t { return _shard_count; }
+
+private:
+    static constexpr uint32_t EMPTY = UINT32_MAX;
+
+    struct Key
+    {
+        POINTTYPE point;
+        uint64_t version;
+        bool operator==(const Key &other) const { return version == other.version && point == other.point; }
+    };
+
+    struct Slot
+    {
+        Key key;
+        VALUE value;
+        uint64_t hash;
+        bool referenced;
+    };
+
+    // a cache line each, so shards locked by different threads do not share one
+    struct alignas(64) Shard
+    {
+        mutable std::mutex mutex;
+        std::vector<Slot> slots;
+        // open addressing with linear probing, slot indices or EMPTY
+        std::vector<uint32_t> table;
+        std::size_t capacity = 1;
+        std::size_t hand = 0;
+        uint64_t hits = 0, misses = 0, evictions = 0;
+
+        // the position holding key, or the empty position ending its probe sequence
+        auto Locate(const Key &key, uint64_t hash) const -> std::size_t
+        {
+            const auto mask = table.size() - 1;
+            auto position = static_cast<std::size_t>(hash) & mask;
+            while (table[position] != EMPTY)
+            {
+                const auto &slot = slots[table[position]];
+                if (slot.hash == hash && slot.key == key)
+                    break;
+                position = (position + 1) & mask;
+            }
+            return position;
+        }
+
+        // backward shift deletion, later entries of the probe run move up into the hole
+        auto Erase(std::size_t hole) -> void
+        {
+            const auto mask = table.size() - 1;
+            auto position = hole;
+            while (true)
+            {
+                position = (position + 1) & mask;
+                if (table[position] == EMPTY)
+                    break;
+                auto home = static_cast<std::size_t>(slots[table[position]].hash) & mask;
+                // moving is allowed unless home lies cyclically in (hole, position]
+                if (((position - home) & mask) >= ((position - hole) & mask))
+                {
+                    table[hole] = table[position];
+                    hole = position;
+                }
+            }
+            table[hole] = EMPTY;
+        }
+    };
+
+    // splitmix64 finalizer, the table uses the low bits and the shard the high bits
+    static auto Hash(const Key &key) -> uint64_t
+    {
+        uint64_t h = std::hash<POINTTYPE>{}(key.point) ^ (key.version * 0x9e3779b97f4a7c15ull);
+        h = (h ^ (h >> 30)) * 0xbf58476d1ce4e5b9ull;
+        h = (h ^ (h >> 27)) * 0x94d049bb133111ebull;
+        return h ^ (h >> 31);
+    }
+
+    auto ShardOf(uint64_t hash) -> Shard & { return _shards[(hash >> 40) & (_shard_count - 1)]; }
+
+    std::unique_ptr<Shard[]> _shards;
+    std::size_t _shard_count = 1;
+};
+
+/**
+ * @brief A classifier answering repeated points from a QueryCacheT.
+ *
+ * Wraps any type with Classify(point) -> PolygonTestResult, so it can be used wherever that
+ * classifier can, e.g. with BatchClassify. Change the version whenever the polygon changes.
+ */
+template <typename CLASSIFIER, typename POINTTYPE>
+class CachedClassifierT
+{
+public:
+    CachedClassifierT(const CLASSIFIER &classifier, QueryCacheT<POINTTYPE> &cache, uint64_t version)
+        : _classifier(classifier), _cache(cache), _version(version)
+    {
+    }
+
+    auto Classify(const POINTTYPE &point) const -> PolygonTestResult
+    {
+        return _cache.GetOrCompute(point, _version, [&]
+                                   { return _classifier.Classify(point); });
+    }
+
+    auto InPolygonTest(const POINTTYPE &point) const -> std::string
+    {
+        return _enumItemStrings[static_cast<int>(Classify(point))];
+    }
+
+    auto SetVersion(uint64_t version) -> void { _version = version; }
+
+private:
+    const CLASSIFIER &_classifier;
+    QueryCacheT<POINTTYPE> &_cache;
+    uint64_t _version;
+};
@@ -48,6 +48,20 @@ struct has_indexer<T, std::void_t<decltype(std::declval<T>()[std::declval<std::s
 template <typename T>
 constexpr auto has_indexer_v = has_indexer<T>::value;
 
+// Define the has_capacity type trait, containers that reallocate once size reaches capacity
+template <typename T, typename = std::void_t<>>
+struct has_capacity : std::false_type
+{
+};
+
+template <typename T>
+struct has_capacity<T, std::void_t<decltype(std::declval<const T &>().capacity())>> : std::true_type
+{
+};
+
+template <typename T>
+constexpr auto has_capacity_v = has_capacity<T>::value;
+
 // Define the is_one_of type trait
 template <typename T, typename... Types>
 struct is_one_of : std::false_type
@@ -84,50 +98,50 @@ using get_coordinate_type_t = typename get_coordinate_type<T>::type;
 
 // Define a type trait to extract x, y coordiates from Point
 template <typename Point>
-std::enable_if_t<is_Point2DT_v<Point>, get_coordinate_type_t<Point>> get_x(const Point &p)
+constexpr std::enable_if_t<is_Point2DT_v<Point>, get_coordinate_type_t<Point>> get_x(const Point &p)
 {
   return p.X();
 };
 
 template <typename Point>
-std::enable_if_t<is_PointXYT_v<Point>, get_coordinate_type_t<Point>> get_x(const Point &p)
+constexpr std::enable_if_t<is_PointXYT_v<Point>, get_coordinate_type_t<Point>> get_x(const Point &p)
 {
   return p.x;
 };
 
 template <typename Point>
-std::enable_if_t<is_Point2DT_v<Point>, get_coordinate_type_t<Point>> get_y(const Point &p)
+constexpr std::enable_if_t<is_Point2DT_v<Point>, get_coordinate_type_t<Point>> get_y(const Point &p)
 {
   return p.Y();
 };
 
 template <typename Point>
-std::enable_if_t<is_PointXYT_v<Point>, get_coordinate_type_t<Point>> get_y(const Point &p)
+constexpr std::enable_if_t<is_PointXYT_v<Point>, get_coordinate_type_t<Point>> get_y(const Point &p)
 {
   return p.y;
 };
 
 // type traits to fix the type of the coordinates to either double or int64_t
 template <typename Point, typename T = get_coordinate_type_t<Point>>
-typename std::enable_if_t<!std::is_integral<T>::value, double> fix_x(const Point &p)
+constexpr typename std::enable_if_t<!std::is_integral<T>::value, double> fix_x(const Point &p)
 {
   return get_x(p);
 };
 
 template <typename Point, typename T = get_coordinate_type_t<Point>>
-typename std::enable_if_t<!std::is_integral<T>::value, double> fix_y(const Point &p)
+constexpr typename std::enable_if_t<!std::is_integral<T>::value, double> fix_y(const Point &p)
 {
   return get_y(p);
 };
 
 template <typename Point, typename T = get_coordinate_type_t<Point>>
-typename std::enable_if_t<std::is_integral<T>::value, int64_t> fix_x(const Point &p)
+constexpr typename std::enable_if_t<std::is_integral<T>::value, int64_t> fix_x(const Point &p)
 {
   return static_cast<int64_t>(get_x(p));
 };
 
 template <typename Point, typename T = get_coordinate_type_t<Point>>
-typename std::enable_if_t<std::is_integral<T>::value, int64_t> fix_y(const Point &p)
+constexpr typename std::enable_if_t<std::is_integral<T>::value, int64_t> fix_y(const Point &p)
 {
   return static_cast<int64_t>(get_y(p));
 };
@@ -140,33 +154,49 @@ struct is_unsigned_integer
 template<typename T>
 constexpr bool is_unsigned_integer_v = is_unsigned_integer<T>::value;
 
-// type traits to create a positve or negative extreme value
+// type trait to check if a type is a signed integer
+template<typename T>
+struct is_signed_integer
+    : std::integral_constant<bool, std::is_integral<T>::value && std::is_signed<T>::value> {};
+
+template<typename T>
+constexpr bool is_signed_integer_v = is_signed_integer<T>::value;
+
+// type traits to create a positve or negative extreme value, for every floating point,
+// signed and unsigned integer coordinate type, e.g. float, int16_t or int64_t
+template <typename T>
+constexpr typename std::enable_if_t<std::is_floating_point<T>::value, T> create_max(const T &p)
+{
+  return std::min<T>(p < 0 ? -p : p, std::numeric_limits<T>::max());
+}
+
 template <typename T>
-typename std::enable_if_t<!is_unsigned_integer_v<T>, T> create_max(const T &p)
+constexpr typename std::enable_if_t<is_signed_integer_v<T>, T> create_max(const T &p)
 {
-  return std::min(p < 0 ? -p : p, std::numeric_limits<T>::max());
+  // -min is not representable, and small types promote to int when negated
+  return p == std::numeric_limits<T>::min() ? std::numeric_limits<T>::max() : static_cast<T>(p < 0 ? -p : p);
 }
 
 template <typename T>
-typename std::enable_if_t<is_unsigned_integer_v<T>, T> create_max(const T &p)
+constexpr typename std::enable_if_t<is_unsigned_integer_v<T>, T> create_max(const T &p)
 {
   return std::min(p, std::numeric_limits<T>::max());
 }
 
 template <typename T>
-typename std::enable_if_t<is_unsigned_integer_v<T>, T> create_min(const T &p)
+constexpr typename std::enable_if_t<is_unsigned_integer_v<T>, T> create_min(const T &p)
 {
   return 0;
 }
 
 template <typename T>
-typename std::enable_if_t<std::is_same<T, double>::value, T> create_min(const T &p)
+constexpr typename std::enable_if_t<std::is_floating_point<T>::value, T> create_min(const T &p)
 {
-  return std::max(p < 0 ? p : -p, -std::numeric_limits<T>::max());
+  return std::max<T>(p < 0 ? p : -p, -std::numeric_limits<T>::max());
 }
 
 template <typename T>
-typename std::enable_if_t<std::is_same<T, int>::value, T> create_min(const T &p)
+constexpr typename std::enable_if_t<is_signed_integer_v<T>, T> create_min(const T &p)
 {
-  return std::max(p < 0 ? p : -p, std::numeric_limits<T>::min());
+  return static_cast<T>(p < 0 ? p : -p);
 }